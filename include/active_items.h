@@ -0,0 +1,71 @@
+//===-- active_items.h - Dense active item sizes ----------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Contiguous array of the sizes of uncovered items, for vectorised selection.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dlx {
+//===-- active items ------------------------------------------------------===//
+/// The sizes of the items that remain to be covered, kept in a dense array so
+/// that the item with the fewest options is found by a vectorised reduction
+/// instead of by following the links between items. Covered items are
+/// swap-removed past the end of the active range; since items are uncovered
+/// in the reverse order of covering, restoring an item only extends the
+/// range again.
+class active_items {
+public:
+  /// All items start out active, with no options.
+  explicit active_items(std::size_t n_items);
+
+  /// Removes an item from the active range, or restores the item removed
+  /// most recently.
+  /// @{
+  void remove(std::uint32_t item);
+  void restore(std::uint32_t item);
+  /// @}
+
+  /// Updates the number of options covering an item.
+  void resize(std::uint32_t item, std::uint32_t size) {
+    sizes[slots[item]] = size;
+  }
+
+  /// Returns true if all items have been removed.
+  auto empty() const noexcept -> bool { return active == 0; }
+
+  /// Returns the active item with the fewest options, preferring the first
+  /// in the dense array on ties. Requires a non-empty active range.
+  auto minimum() const -> std::uint32_t;
+
+private:
+  std::size_t active;
+  std::vector<std::uint32_t> sizes;
+  std::vector<std::uint32_t> items;
+  std::vector<std::uint32_t> slots;
+};
+} // namespace dlx
@@ -0,0 +1,54 @@
+//===-- backbone.h - Backbone computation -----------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Determines which options belong to some, and which to all exact covers.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "instance.h"
+
+namespace dlx {
+/// For each option of a problem, whether it belongs to some exact cover and
+/// whether it belongs to all of them. Unsatisfiable problems have no option
+/// in either.
+struct backbone {
+  std::vector<bool> in_some = {};
+  std::vector<bool> in_all = {};
+
+  /// Number of searches needed, each for a single exact cover.
+  std::size_t searches = 0;
+};
+
+/// Computes the backbone of a problem on <n_threads> threads. Every exact
+/// cover found marks all its options as witnessed; a search is only run for
+/// options not witnessed yet, selecting the option and looking for a single
+/// exact cover extending it. An option belongs to all exact covers exactly
+/// if no other option sharing an item with it belongs to any, so that
+/// follows without further searching.
+auto compute_backbone(const instance &problem, std::size_t n_threads)
+    -> backbone;
+} // namespace dlx
@@ -0,0 +1,164 @@
+//===-- batch_solver.h - Batch solving --------------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Thread pool solving streams of small, independent exact cover problems.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "dancing_links.h"
+#include "instance.h"
+
+namespace dlx {
+class result_cache;
+
+/// What a batch solver computes for an instance.
+enum class solve_mode {
+  first, ///< A single exact cover, if any.
+  all,   ///< All exact covers.
+  count, ///< The number of exact covers only.
+};
+
+/// Outcome of solving a single instance submitted to a batch solver.
+struct batch_result {
+  /// Number of exact covers found. In <first> mode this is at most one.
+  std::size_t count = 0;
+
+  /// Exact covers found, unless only counting.
+  std::vector<std::vector<std::size_t>> solutions = {};
+
+  /// False if the search ran out of budget, leaving the count and the
+  /// solutions incomplete.
+  bool complete = true;
+
+  /// Time from submission to completion, including time spent queued.
+  std::chrono::nanoseconds latency = {};
+};
+
+/// Latency percentiles over all instances completed so far.
+struct latency_summary {
+  std::size_t samples = 0;
+  std::chrono::nanoseconds p50 = {};
+  std::chrono::nanoseconds p90 = {};
+  std::chrono::nanoseconds p99 = {};
+  std::chrono::nanoseconds max = {};
+};
+
+//===-- batch solver ------------------------------------------------------===//
+/// Thread pool solving independent instances. Each instance is solved
+/// sequentially on one worker, so that small instances do not pay for
+/// coordination between threads; throughput comes from solving many
+/// instances at once. Each worker builds its matrices in a private arena
+/// whose buffer is reused from one instance to the next.
+class batch_solver {
+public:
+  /// Starts <n_threads> worker threads.
+  explicit batch_solver(std::size_t n_threads = default_threads());
+
+  /// Workers are tied to the solver's queue, which cannot be relocated.
+  /// @{
+  batch_solver(const batch_solver &) = delete;
+  batch_solver &operator=(const batch_solver &) = delete;
+  /// @}
+
+  /// Finishes all instances submitted so far, then stops the workers.
+  ~batch_solver();
+
+  /// Queues an instance for solving. In <all> mode, at most <max_solutions>
+  /// exact covers are kept; further ones are only counted. The search stops
+  /// early once it exceeds <budget>.
+  auto submit(instance problem, solve_mode mode = solve_mode::all,
+              std::size_t max_solutions = unlimited,
+              search_budget budget = {}) -> std::future<batch_result>;
+
+  /// Attaches a cache consulted before building a matrix for an instance,
+  /// and filled with the results of instances that missed it. Must be set
+  /// before submitting any instances; null detaches the cache.
+  void set_cache(result_cache *cache) { this->cache = cache; }
+
+  /// Returns latency percentiles over all instances completed so far.
+  auto latencies() const -> latency_summary;
+
+  /// Keeps all exact covers found.
+  static constexpr auto unlimited = static_cast<std::size_t>(-1);
+
+  /// Number of worker threads used when none is specified.
+  static auto default_threads() -> std::size_t {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  /// An instance waiting to be solved.
+  struct job {
+    instance problem;
+    solve_mode mode;
+    std::size_t max_solutions;
+    search_budget budget;
+    std::promise<batch_result> promise;
+    clock::time_point submitted;
+  };
+
+  /// A worker thread with the latencies of the instances it completed.
+  /// Latencies are only shared when a summary is requested.
+  struct worker {
+    std::thread thread = {};
+    std::vector<std::byte> arena = {};
+    mutable std::mutex mutex = {};
+    std::vector<std::chrono::nanoseconds> latencies = {};
+  };
+
+  /// Takes jobs off the queue until the solver is destroyed.
+  void run(worker &self);
+
+  /// Solves a single instance within the limits of <current>, building its
+  /// matrix from <resource>.
+  static auto solve(const instance &problem, const job &current,
+                    std::pmr::memory_resource *resource) -> batch_result;
+
+  /// Answers an instance from the cache, or solves its canonical form and
+  /// caches the result if it is complete and no exact covers were left out.
+  auto solve_cached(const job &current, std::pmr::memory_resource *resource)
+      -> batch_result;
+
+  std::mutex mutex = {};
+  std::condition_variable available = {};
+  std::deque<job> queue = {};
+  bool stopping = false;
+  result_cache *cache = nullptr;
+  std::vector<std::unique_ptr<worker>> workers = {};
+};
+} // namespace dlx
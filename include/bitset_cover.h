@@ -0,0 +1,99 @@
+//===-- bitset_cover.h - Bitset exact cover ---------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Word-parallel search over exact cover problems of at most 64 items.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace dlx {
+//===-- bitset cover ------------------------------------------------------===//
+/// Exact cover problem of at most 64 items, with each option stored as a
+/// bitmask of its items. Compatibility of an option with the items that
+/// remain uncovered is a single mask test, so small problems are searched
+/// without chasing any pointers. Storage is kept between problems.
+class bitset_cover {
+public:
+  static constexpr std::size_t max_items = 64;
+
+  /// Starts a new problem of <n_items> items without options.
+  void reset(std::size_t n_items);
+
+  /// Adds an option covering the items in <mask>, reported as <index>.
+  void add_option(std::uint64_t mask, std::size_t index);
+
+  /// Mask of all items of the current problem.
+  auto all_items() const noexcept -> std::uint64_t { return all; }
+
+  /// Searches for exact covers of the items in <uncovered>, appending the
+  /// indices of the options chosen to <selection> and calling <found> for
+  /// every cover. Returns true as soon as <found> does, leaving the cover in
+  /// <selection>; otherwise <selection> is restored before returning false.
+  template <typename Selection, typename Found>
+  auto search(std::uint64_t uncovered, Selection &selection, Found &&found)
+      -> bool {
+    if (uncovered == 0)
+      return found();
+
+    auto best = std::size_t{0};
+    auto fewest = std::numeric_limits<std::size_t>::max();
+    for (auto remaining = uncovered; remaining != 0;
+         remaining &= remaining - 1) {
+      auto item = static_cast<std::size_t>(std::countr_zero(remaining));
+      auto count = std::size_t{0};
+      for (auto option : containing[item])
+        count += (masks[option] & ~uncovered) == 0;
+      if (count < fewest) {
+        best = item;
+        fewest = count;
+        if (count <= 1)
+          break;
+      }
+    }
+
+    for (auto option : containing[best]) {
+      if ((masks[option] & ~uncovered) != 0)
+        continue;
+      selection.push_back(indices[option]);
+      if (search(uncovered & ~masks[option], selection, found))
+        return true;
+      selection.pop_back();
+    }
+    return false;
+  }
+
+private:
+  std::uint64_t all = 0;
+  std::size_t used = 0;
+  std::vector<std::uint64_t> masks = {};
+  std::vector<std::size_t> indices = {};
+  std::array<std::vector<std::uint32_t>, max_items> containing = {};
+};
+} // namespace dlx
@@ -0,0 +1,70 @@
+//===-- canonical_form.h - Canonical problem form ---------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Relabelling of exact cover problems into a form shared by isomorphic
+/// problems.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "instance.h"
+
+namespace dlx {
+//===-- canonical form ----------------------------------------------------===//
+/// An exact cover problem with its items and options renumbered into a
+/// canonical order, so that problems differing only in their numbering share
+/// the same form and hash.
+struct canonical_instance {
+  /// The renumbered problem, with the items of each option in increasing
+  /// order and the options in lexicographic order. Positions of cells, if
+  /// any, follow their items.
+  instance problem = {};
+
+  /// Original index of each option of the renumbered problem.
+  std::vector<std::size_t> options = {};
+
+  /// Hash of the renumbered problem.
+  std::uint64_t hash = 0;
+
+  /// Translates a solution of the renumbered problem back to the original
+  /// option indices.
+  auto original(std::span<const std::size_t> solution) const
+      -> std::vector<std::size_t>;
+};
+
+/// Renumbers a problem into canonical form. Items are told apart by colour
+/// refinement: each item starts out coloured by the number of options
+/// containing it, and is recoloured by the colours of the options containing
+/// it, options being coloured by their items, until the colours stabilise.
+/// Items that refinement cannot tell apart are individualised one by one,
+/// and the smallest relabelled problem among the resulting numberings is
+/// chosen. For highly symmetric problems the search is cut short, so that
+/// some isomorphic problems end up with different forms; those merely fail
+/// to share cached results.
+auto canonicalize(const instance &problem) -> canonical_instance;
+} // namespace dlx
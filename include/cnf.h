@@ -0,0 +1,60 @@
+//===-- cnf.h - CNF export --------------------------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Conversion of exact cover problems to satisfiability problems in DIMACS CNF,
+/// and of satisfying assignments back to exact covers.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <optional>
+#include <vector>
+
+#include "dancing_links.h"
+
+namespace dlx {
+/// Settings for the CNF encoding.
+struct cnf_settings {
+  /// Items covered by at most this many options forbid pairs of them
+  /// directly; items with more options use a sequential counter, which needs
+  /// a linear rather than quadratic number of clauses.
+  std::size_t pairwise_limit = 4;
+};
+
+/// Writes the problem as DIMACS CNF. Variable i + 1 is true if option i is
+/// part of the exact cover; further variables are auxiliary. Each item gets
+/// a clause requiring at least one of its options and an encoding of at most
+/// one. Clauses are streamed straight from the item lists of the matrix,
+/// which must have an empty selection.
+void write_cnf(std::ostream &stream, dancing_links &problem,
+               const cnf_settings &settings = {});
+
+/// Reads a model as printed by SAT solvers, either as "v" lines in SAT
+/// competition format or as a plain list of literals, and returns the
+/// options whose variables are true. Returns nothing if the solver reported
+/// the problem unsatisfiable or the model cannot be parsed.
+auto read_sat_model(std::istream &stream, std::size_t n_options)
+    -> std::optional<std::vector<std::size_t>>;
+} // namespace dlx
@@ -27,14 +27,26 @@
 
 #pragma once
 
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <functional>
 #include <initializer_list>
 #include <iostream>
 #include <iterator>
+#include <memory_resource>
+#include <optional>
+#include <span>
 #include <type_traits>
 #include <vector>
 
+#include "active_items.h"
+#include "bitset_cover.h"
+#include "frontier_count.h"
+#include "instance.h"
 #include "linked_list.h"
+#include "nogood_store.h"
+#include "perfect_matching.h"
 
 namespace dlx {
 /// A dancing links matrix is a boolean matrix, stored as a circular four-way
@@ -43,13 +55,22 @@ class node;
 class item;
 class option;
 
+/// Tag selecting constructors that leave nodes out of their items' lists, so
+/// that the lists can be linked afterwards, one item at a time.
+struct unlinked_t {
+  explicit unlinked_t() = default;
+};
+inline constexpr unlinked_t unlinked{};
+
 //===-- node --------------------------------------------------------------===//
 /// A node denotes the presence of an item in a given option.
 class node {
 public:
-  /// Constructors for an item header and item.
+  /// Constructors for an item header and item, adding the node to the end
+  /// of the item's list unless <unlinked> is given.
   /// @{
   node(item &top, option &owner);
+  node(item &top, option &owner, unlinked_t);
   /// @}
 
   /// Copy and move constructors and assignment operators are defaulted.
@@ -66,7 +87,7 @@ public:
   void uncover();
   /// @}
 
-  /// A node can hide or unhide its parent option.
+  /// A node can hide or unhide the other nodes of its parent option.
   /// @{
   void hide();
   void unhide();
@@ -96,6 +117,9 @@ public:
   // auto parent_option() const noexcept -> const option & { return *owner; };
   auto parent_option() noexcept -> option & { return owner; };
 
+  /// Returns the item whose presence this node denotes.
+  auto parent_item() noexcept -> item & { return top; };
+
 private:
   node *up, *down;
   item &top;
@@ -110,14 +134,28 @@ public:
   option(std::size_t index) : index{index} {};
 
   /// Constructor creating an option covering the columns indexed using the
-  /// given initializer list set.
+  /// given set. Its nodes are allocated from <resource>.
+  /// @{
+  option(std::size_t index, linked_list<item> &items,
+         std::initializer_list<std::size_t> set,
+         std::pmr::memory_resource *resource =
+             std::pmr::get_default_resource());
   option(std::size_t index, linked_list<item> &items,
-         std::initializer_list<std::size_t> set);
+         const std::vector<std::size_t> &set,
+         std::pmr::memory_resource *resource =
+             std::pmr::get_default_resource());
+  option(std::size_t index, linked_list<item> &items,
+         const std::vector<std::size_t> &set, unlinked_t,
+         std::pmr::memory_resource *resource =
+             std::pmr::get_default_resource());
+  /// @}
 
-  /// Hides/unhides this option from the candidate solution set.
+  /// Hides/unhides this option from the candidate solution set. The node
+  /// through which the option is reached is left in place, so that the item
+  /// list being traversed remains intact.
   /// @{
-  void hide();
-  void unhide();
+  void hide(const node &except);
+  void unhide(const node &except);
   /// @}
 
   /// (Un)covering an option (un)covers all items part of this option.
@@ -126,14 +164,27 @@ public:
   void uncover();
   /// @}
 
+  /// Versions of the above for options of <Width> nodes, with the loops over
+  /// the nodes unrolled. A width of zero loops over a runtime number of
+  /// nodes instead.
+  /// @{
+  template <std::size_t Width> void hide(const node &except);
+  template <std::size_t Width> void unhide(const node &except);
+  template <std::size_t Width> void cover();
+  template <std::size_t Width> void uncover();
+  /// @}
+
   /// Returns the index corresponding with the option.
   auto get_index() const -> std::size_t { return index; };
 
   /// Number of items covered by this option.
   auto size() const -> std::size_t { return covered.size(); };
 
+  /// The nodes denoting the items covered by this option.
+  auto nodes() noexcept -> std::span<node> { return covered; };
+
 private:
-  std::vector<node> covered;
+  std::pmr::vector<node> covered;
   std::size_t index;
 };
 
@@ -152,6 +203,13 @@ public:
   void uncover();
   /// @}
 
+  /// Versions of the above for problems whose options all consist of
+  /// <Width> nodes, or of any number of nodes if <Width> is zero.
+  /// @{
+  template <std::size_t Width> void cover();
+  template <std::size_t Width> void uncover();
+  /// @}
+
   /// An item can reversibly remove itself from the parent linked list.
   /// @{
   void remove() const;
@@ -168,8 +226,12 @@ public:
   /// of options covering it is non-zero.
   auto satisfiable() const -> bool { return size; }
 
-  /// Adds a node to the item list.
+  /// Adds a node, or <count> nodes already linked from <first> to <last>,
+  /// to the item list.
+  /// @{
   void add_node(node &node);
+  void add_nodes(node &first, node &last, std::size_t count);
+  /// @}
 
   /// Determines whether or not the linked list of items that are yet to be
   /// covered is empty.
@@ -191,14 +253,53 @@ public:
 
   /// Accessors to shrink or grow the size of the linked list of options.
   /// @{
-  void shrink() { size -= 1; };
-  void grow() { size += 1; };
+  void shrink() {
+    size -= 1;
+    if (dense)
+      dense->resize(id, static_cast<std::uint32_t>(size));
+  };
+  void grow() {
+    size += 1;
+    if (dense)
+      dense->resize(id, static_cast<std::uint32_t>(size));
+  };
   /// @}
 
+  /// Mirrors the size and coverage of this item, as item <index>, into a
+  /// dense array of active items, or stops doing so if <active> is null.
+  void track(active_items *active, std::uint32_t index);
+
 private:
   item *left, *right;
   list_view<node> options;
   std::size_t size;
+  active_items *dense = nullptr;
+  std::uint32_t id = 0;
+};
+
+//===-- exact cover -------------------------------------------------------===//
+/// Ways of finding the item with the fewest options to branch on.
+enum class selection_strategy {
+  /// Follows the links between the items that remain to be covered.
+  linked,
+  /// Reduces a dense array of item sizes, which pays off for problems with
+  /// many items. Ties are broken by position in the dense array, which
+  /// deviates from the item order as items are covered and uncovered.
+  dense,
+};
+
+/// Bounds on the searches of a matrix, which stop early once any of them is
+/// reached.
+struct search_budget {
+  /// Search nodes visited at most, over all searches.
+  std::size_t nodes = static_cast<std::size_t>(-1);
+
+  /// Time by which searches must be done.
+  std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::time_point::max();
+
+  /// Flag stopping searches once set, possibly from another thread.
+  const std::atomic<bool> *cancelled = nullptr;
 };
 
 //===-- exact cover -------------------------------------------------------===//
@@ -207,10 +308,44 @@ private:
 /// search for covering subsets.
 class dancing_links {
 public:
-  /// Constructs an exact cover problem with a given number of items.
-  dancing_links::dancing_links(
-      std::size_t n_items,
-      std::initializer_list<std::initializer_list<std::size_t>> sets);
+  /// Callback invoked with the option indices of each exact cover found.
+  using visitor = std::function<void(std::span<const std::size_t>)>;
+
+  /// Constructs an exact cover problem with a given number of items. All
+  /// storage of the matrix and search state is allocated from <resource>, so
+  /// that an arena can release it in one go once solving is done. Solutions
+  /// returned to the caller outlive the matrix and use the global heap.
+  /// @{
+  dancing_links(std::size_t n_items,
+                std::initializer_list<std::initializer_list<std::size_t>> sets);
+  dancing_links(std::size_t n_items,
+                const std::vector<std::vector<std::size_t>> &sets,
+                std::pmr::memory_resource *resource =
+                    std::pmr::get_default_resource());
+  explicit dancing_links(const instance &problem,
+                         std::pmr::memory_resource *resource =
+                             std::pmr::get_default_resource());
+  /// @}
+
+  /// Constructs an exact cover problem, linking the nodes into their items'
+  /// lists on <n_threads> threads. Without a thread count, nodes are linked
+  /// on the calling thread, as callers such as the batch solver already run
+  /// one matrix per thread.
+  /// @{
+  dancing_links(std::size_t n_items,
+                const std::vector<std::vector<std::size_t>> &sets,
+                std::pmr::memory_resource *resource, std::size_t n_threads);
+  dancing_links(const instance &problem, std::size_t n_threads,
+                std::pmr::memory_resource *resource =
+                    std::pmr::get_default_resource());
+  /// @}
+
+  /// Nodes refer to their items and options by address, so the matrix can be
+  /// neither copied nor moved.
+  /// @{
+  dancing_links(const dancing_links &) = delete;
+  dancing_links &operator=(const dancing_links &) = delete;
+  /// @}
 
   /// Searches the set of options for all subsets exactly covering all items.
   auto solve() -> std::vector<std::vector<std::size_t>>;
@@ -218,19 +353,209 @@ public:
   /// Searches the set of options for a subset exactly covering all items.
   auto quicksolve() -> std::vector<std::size_t>;
 
-private:
-  /// Returns true if the current subset of options covers all items.
+  /// Calls <visit> for every subset exactly covering all items, without
+  /// storing the subsets found.
+  void enumerate(const visitor &visit);
+
+  /// Counts the number of subsets exactly covering all items.
+  auto count() -> std::size_t;
+
+  /// Options can be selected by hand, restricting the search to subsets that
+  /// contain them. Selections must be undone in reverse order.
+  /// @{
+  void select(std::size_t index);
+  void deselect();
+  /// @}
+
+  /// Returns the indices of the options covering the item that the search
+  /// would branch on next, given the current selection.
+  auto candidates() -> std::vector<std::size_t>;
+
+  /// Returns true if the current selection covers all items.
   auto exact_cover() const -> bool;
 
+  /// Returns the indices of the currently selected options.
+  auto selection() const -> std::span<const std::size_t> {
+    return current_subset;
+  }
+
+  /// Dimensions of the matrix.
+  /// @{
+  auto item_count() const noexcept -> std::size_t { return n_items; }
+  auto option_count() const noexcept -> std::size_t { return options.size(); }
+  /// @}
+
+  /// Iterable over the nodes of the options currently covering an item, in
+  /// the order of their options.
+  auto column(std::size_t index) -> list_view<node> & {
+    return items[index].covering_options();
+  }
+
+  /// Reorders the items, which decides between items with equally many
+  /// options when choosing the next item to cover. Requires an empty
+  /// selection; <order> must be a permutation of the item indices.
+  void order_items(std::span<const std::size_t> order);
+
+  /// Number of items covered by every option, or zero if options differ in
+  /// size. Searches over problems with uniform options of up to
+  /// <max_unrolled> items use loops unrolled for that width.
+  auto uniform_width() const noexcept -> std::size_t { return width; }
+  static constexpr std::size_t max_unrolled = 8;
+
+  /// Finishes the search with bitsets once at most <bitset_cover::max_items>
+  /// items and at most <options> options remain, leaving the matrix as it
+  /// is. Zero disables the switch, which is the default. Lookahead is not
+  /// applied below the switch.
+  void set_bitset_threshold(std::size_t options);
+
+  /// Enables or disables solving problems in which every option covers two
+  /// items as perfect matchings of the graph with the items as vertices.
+  /// While enabled, which is the default, <quicksolve> without a selection
+  /// finds a matching with the blossom algorithm, and <count> without a
+  /// selection counts matchings directly, unless lookahead or nogoods are
+  /// enabled.
+  void set_matching(bool enabled) noexcept { matching = enabled; }
+
+  /// Enables or disables counting exact covers of problems constructed from
+  /// an instance with a board by sweeping over it, see <count_by_sweep>.
+  /// While enabled, which is the default, <count> without a selection sweeps
+  /// if possible, unless lookahead or nogoods are enabled. Problems that can
+  /// also be counted as perfect matchings are only swept if that keeps the
+  /// frontier narrower than numbering the items as given does.
+  void set_sweeping(bool enabled) noexcept { sweeping = enabled; }
+
+  /// Changes how the item to branch on is chosen. Requires an empty
+  /// selection.
+  void set_selection_strategy(selection_strategy strategy);
+
+  /// Counts the nodes of the search tree below the current selection, giving
+  /// up once <limit> nodes have been visited.
+  auto tree_size(std::size_t limit) -> std::size_t;
+
+  /// Enables lookahead at the search depths d for which depths[d] is set.
+  /// Before branching on an option at such a depth, the option is covered
+  /// tentatively and items left with a single option are covered in turn;
+  /// the option is pruned if this leaves some item unsatisfiable.
+  void set_lookahead(std::vector<bool> depths);
+
+  /// Number of options pruned by lookahead so far.
+  auto pruned_options() const noexcept -> std::size_t { return pruned; }
+
+  /// Attaches a store of nogoods, or detaches it if <store> is null. While a
+  /// store is attached, <enumerate> derives a conflict set of selected options
+  /// for every subtree without solutions, records it as a nogood, and skips
+  /// options that would complete a known nogood. When a subtree's conflict
+  /// set does not involve the option branched on, the remaining siblings are
+  /// skipped as well. Lookahead is not applied while learning.
+  void set_nogood_store(nogood_store *store);
+
+  /// Limits the searches that follow. A search running out of budget stops
+  /// early, returning or visiting only what it found so far, after which
+  /// <stopped> returns true. Finding a perfect matching, which takes
+  /// polynomial time, is not limited.
+  void set_budget(search_budget budget);
+
+  /// Returns true if a search ran out of budget.
+  auto stopped() const noexcept -> bool { return halted; }
+
+private:
+  /// Marks the absence of an option.
+  static constexpr auto none = static_cast<std::size_t>(-1);
+
+  /// Links the nodes of all options into their items' lists on <n_threads>
+  /// threads: once over slices of the options, into partial lists per item,
+  /// and once over slices of the items, joining their partial lists.
+  void link_columns(std::size_t n_threads);
+
+  /// Counts a search node, returning true once the budget is spent. The
+  /// clock and the cancellation flag are only checked every
+  /// <budget_interval> nodes.
+  auto out_of_budget() -> bool;
+  static constexpr std::size_t budget_interval = 1024;
+
   /// Returns the next item to be covered.
   auto next_candidate() -> item &;
 
+  /// Visits the search tree below the current selection, counting nodes in
+  /// <visited> until it reaches <limit>.
+  void explore(std::size_t &visited, std::size_t limit);
+
+  /// Returns true if lookahead is enabled at the current depth.
+  auto looks_ahead() const -> bool;
+
+  /// Copies the remaining items and options into <residual>, unless there
+  /// are too many of them for the bitset search.
+  auto compact() -> bool;
+
+  /// Returns false if covering <option> and propagating items with a single
+  /// remaining option leaves some item unsatisfiable.
+  auto consistent(option &option) -> bool;
+
+  /// Recursive searches behind <quicksolve> and behind <enumerate> when not
+  /// learning nogoods, for options of <Width> items.
+  /// @{
+  template <std::size_t Width> auto find() -> std::vector<std::size_t>;
+  template <std::size_t Width> void search(const visitor &visit);
+  /// @}
+
+  /// Recursive search behind <enumerate> when learning nogoods. Returns true
+  /// if some exact cover was found; otherwise <conflict> holds a set of
+  /// selected options that together rule out any exact cover.
+  auto learn(const visitor &visit, std::vector<std::size_t> &conflict)
+      -> bool;
+
+  /// Adds or removes an option from the current selection.
+  /// @{
+  void choose(option &option);
+  void unchoose(option &option);
+  /// @}
+
+  /// Returns true if nothing is selected, and the search neither prunes nor
+  /// learns.
+  auto plain() const -> bool;
+
+  /// Returns true if the problem is to be solved as a perfect matching.
+  auto matches() const -> bool;
+
+  /// Returns true if exact covers are to be counted by sweeping the board.
+  auto sweeps() const -> bool;
+
+  /// Returns a selected option conflicting with option <index>, if any.
+  auto blocker(std::size_t index) -> std::size_t;
+
+  /// Returns the index of an item.
+  auto index_of(item &item) -> std::size_t;
+
   /// Adds a new item that must be covered.
   void add_item();
 
-  linked_list<item> items = {};
-  std::vector<option> options = {};
-  std::vector<std::size_t> current_subset = {};
+  std::size_t n_items;
+  std::size_t width = 0;
+  std::size_t longest = 0;
+  linked_list<item> items;
+  std::pmr::vector<option> options;
+  std::pmr::vector<std::size_t> current_subset;
+  std::pmr::vector<option *> forced;
+  std::vector<bool> lookahead_depths = {};
+  std::size_t pruned = 0;
+  nogood_store *nogoods = nullptr;
+  std::vector<std::vector<std::size_t>> columns = {};
+  std::vector<std::size_t> covered_by = {};
+  std::vector<bool> selected = {};
   std::vector<std::vector<std::size_t>> solutions = {};
+  std::optional<active_items> dense = {};
+  std::size_t bitset_threshold = 0;
+  bitset_cover residual = {};
+  std::vector<std::uint8_t> bit_of = {};
+  std::vector<std::size_t> compacted_at = {};
+  std::size_t compactions = 0;
+  bool matching = true;
+  std::vector<edge> edges = {};
+  std::size_t edge_reach = 0;
+  bool sweeping = true;
+  std::optional<board_sweep> sweep = {};
+  search_budget budget = {};
+  std::size_t spent = 0;
+  bool halted = false;
 };
 } // namespace dlx
\ No newline at end of file
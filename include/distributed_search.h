@@ -0,0 +1,91 @@
+//===-- distributed_search.h - Coordinator and worker processes -*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Dynamic load balancing of a search over worker processes.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "instance.h"
+
+namespace dlx {
+/// Settings for a search distributed over worker processes.
+struct distribution_settings {
+  /// Number of worker processes.
+  std::size_t workers = 4;
+
+  /// Worker executable, started with the --worker flag and its end of the
+  /// connection on standard input and output. If empty, workers are forked
+  /// from the coordinator and run <run_worker> directly; the coordinator
+  /// must then have no other threads running.
+  std::filesystem::path executable = {};
+
+  /// Workers started to replace crashed ones before giving up on them.
+  std::size_t restarts = 4;
+};
+
+//===-- coordinator -------------------------------------------------------===//
+/// Search over a number of worker processes, balanced at run time. Work is
+/// handed out as prefixes: option indices to select before searching the
+/// subtree below them. Whenever a worker runs idle, the coordinator asks a
+/// busy worker to donate the unexplored options at the shallowest level of
+/// its search, and hands these out as new prefixes. Results of a prefix
+/// only count once its worker reports it finished, so if a worker crashes,
+/// its prefix is reissued, excluding the subtrees it donated, without
+/// counting any solution twice.
+class coordinator {
+public:
+  explicit coordinator(instance problem, distribution_settings settings = {});
+
+  /// Counts or finds all exact covers. Returns nothing if every worker
+  /// crashed before the search was complete.
+  /// @{
+  auto count() -> std::optional<std::size_t>;
+  auto solve() -> std::optional<std::vector<std::vector<std::size_t>>>;
+  /// @}
+
+  /// Replaces the function run by forked workers, which is passed the
+  /// worker's end of the connection and the number of workers started
+  /// before it. Meant for fault injection.
+  void set_worker_entry(std::function<void(int, std::size_t)> entry);
+
+private:
+  /// Runs a search, keeping solutions unless only counting.
+  auto run(bool keep_solutions, std::size_t &total,
+           std::vector<std::vector<std::size_t>> &solutions) -> bool;
+
+  instance problem;
+  distribution_settings settings;
+  std::function<void(int, std::size_t)> entry = {};
+};
+
+/// Serves a coordinator as a worker over a connection, until told to quit or
+/// the connection is lost. Returns false if the connection was lost.
+auto run_worker(int input, int output) -> bool;
+} // namespace dlx
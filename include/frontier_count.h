@@ -0,0 +1,81 @@
+//===-- frontier_count.h - Frontier counting --------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Counts the exact covers of tiling problems by sweeping over their board.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "instance.h"
+
+namespace dlx {
+/// The options of a tiling problem, rearranged for sweeping over its board
+/// along its longer side: column by column if the board is at least as wide
+/// as it is tall, and row by row otherwise. Cells are numbered in the order
+/// of the sweep; items not on the board are numbered separately, as bits.
+struct board_sweep {
+  /// An option, as the cells it covers in increasing order and the items
+  /// off the board it covers.
+  struct placement {
+    std::vector<std::size_t> cells = {};
+    std::uint64_t others = 0;
+  };
+
+  std::size_t n_cells = 0;
+  std::uint64_t all_others = 0;
+
+  /// Largest distance in sweep order between the first and last cell of a
+  /// placement, which bounds how far the frontier reaches past its first
+  /// uncovered cell.
+  std::size_t reach = 0;
+
+  /// Placements by the first cell they cover.
+  std::vector<std::vector<placement>> starting_at = {};
+
+  /// Most items off the board that a sweep can keep track of.
+  static constexpr std::size_t max_others = 64;
+};
+
+/// Prepares a sweep over the board of <problem>. Returns nothing if the
+/// problem has no board, has more than <board_sweep::max_others> items off
+/// the board, or has an option covering no cell.
+auto plan_sweep(const instance &problem) -> std::optional<board_sweep>;
+
+/// Counts the exact covers by always covering the first uncovered cell of
+/// the sweep. A partial cover then reduces to that cell, the cells after it
+/// that are covered already, and the items off the board that are covered;
+/// partial covers are merged on these, in order of the cell. The covered
+/// cells lie within reach of a placement from the first uncovered one, so
+/// for boards swept along their length the time taken grows linearly with
+/// the length, and only exponentially with the width.
+/// Counting gives up, returning zero, once <stop> returns true; it is called
+/// for every partial cover extended.
+auto count_by_sweep(const board_sweep &sweep,
+                    const std::function<bool()> &stop = {}) -> std::size_t;
+} // namespace dlx
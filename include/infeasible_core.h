@@ -0,0 +1,63 @@
+//===-- infeasible_core.h - Infeasible cores --------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Extraction of small sets of items that already admit no exact cover.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "instance.h"
+
+namespace dlx {
+/// Returns the problem of covering only <items>, which must be distinct:
+/// every option is cut down to the items it shares with <items>, and items
+/// are renumbered by their position in <items>. Options left empty are
+/// dropped, as they can always be left out of an exact cover. Positions of
+/// cells follow their items.
+auto restrict_items(const instance &problem, std::span<const std::size_t> items)
+    -> instance;
+
+/// A set of items whose restriction has no exact cover, while the
+/// restriction to any smaller subset of them has one.
+struct infeasible_core {
+  std::vector<std::size_t> items = {};
+
+  /// Number of searches needed, each for a single exact cover.
+  std::size_t searches = 0;
+};
+
+/// Finds an infeasible core of a problem without exact covers, or nothing if
+/// it has one. Exact covers of a restriction are also exact covers of every
+/// restriction to fewer items, so items can be removed as long as the
+/// remaining ones stay infeasible: first in large chunks, then in halving
+/// chunks down to single items. Each check looks for a single exact cover,
+/// and is skipped if an exact cover found before already covers the
+/// remaining items.
+auto find_infeasible_core(const instance &problem)
+    -> std::optional<infeasible_core>;
+} // namespace dlx
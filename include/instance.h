@@ -0,0 +1,53 @@
+//===-- instance.h - Problem instance ---------------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Plain representation of an exact cover problem, independent of the data
+/// structures used to solve it.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace dlx {
+//===-- instance ----------------------------------------------------------===//
+/// Position of an item that is a cell of a board.
+struct cell {
+  std::size_t row = 0;
+  std::size_t column = 0;
+
+  auto operator==(const cell &) const -> bool = default;
+};
+
+/// An exact cover problem as plain data: the number of items and, for each
+/// option, the indices of the items it covers. Tiling problems may give the
+/// position on the board of each item that is a cell of it; <cells> is then
+/// indexed by item, and otherwise empty.
+struct instance {
+  std::size_t items = 0;
+  std::vector<std::vector<std::size_t>> options = {};
+  std::vector<std::optional<cell>> cells = {};
+};
+} // namespace dlx
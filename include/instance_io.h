@@ -0,0 +1,75 @@
+//===-- instance_io.h - Instance text format --------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Reading and writing exact cover problems in a line-based text format.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "instance.h"
+
+namespace dlx {
+/// Problems are stored in the text format of Knuth's DLX programs: the first
+/// line names the items, and every following line lists the names of the
+/// items covered by one option. Names are separated by whitespace, blank
+/// lines and lines starting with '|' are ignored. Secondary items and colors
+/// are not supported, so names may not contain '|' or ':'. Returns nothing
+/// if the text is malformed, names an unknown item, or lists an item twice.
+/// Items are not given positions, so tiling problems read from text are not
+/// counted by sweeping.
+/// @{
+auto parse_instance(std::string_view text) -> std::optional<instance>;
+auto read_instance(std::istream &stream) -> std::optional<instance>;
+/// @}
+
+/// Parses the text format on up to <n_threads> threads, splitting the
+/// options into chunks at line boundaries. Meant for large files, where a
+/// single thread would take longer to parse than to build the matrix.
+auto parse_instance(std::string_view text, std::size_t n_threads)
+    -> std::optional<instance>;
+
+/// Writes a problem in the text format, naming items by their index. Empty
+/// options and problems without items cannot be represented, and positions
+/// of cells are left out, as the format has no place for them.
+void write_instance(std::ostream &stream, const instance &problem);
+
+/// Problems are exchanged between processes in a binary format: the number
+/// of items and of options, then for each option its size followed by its
+/// items, all as 32-bit little-endian integers. Problems with positioned
+/// cells continue with, for each item, 1 followed by its row and column, or
+/// 0 if it is not a cell. Decoding returns nothing if the data is truncated,
+/// has trailing bytes, names an unknown item, or lists an item twice within
+/// an option.
+/// @{
+auto encode_instance(const instance &problem) -> std::vector<std::uint8_t>;
+auto decode_instance(std::span<const std::uint8_t> data)
+    -> std::optional<instance>;
+/// @}
+} // namespace dlx
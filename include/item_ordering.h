@@ -0,0 +1,69 @@
+//===-- item_ordering.h - Item ordering -------------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Profile-guided ordering of items, deciding between items with equally many
+/// options during search.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "instance.h"
+
+namespace dlx {
+/// Settings controlling how much effort is spent on probing.
+struct probe_settings {
+  /// Number of random item orders each item is probed under.
+  std::size_t probes = 4;
+
+  /// Search tree nodes explored below each option before giving up.
+  std::size_t node_limit = 256;
+
+  /// Seed for the random item orders.
+  std::uint64_t seed = 0;
+};
+
+/// Determines an item order by probing: each item is branched on first, and
+/// the subtrees below its options are explored up to a node limit, with the
+/// remaining items in random order. Items with the smallest subtrees come
+/// first in the returned order, to be passed to
+/// <dancing_links::order_items>.
+auto probe_item_order(const instance &problem,
+                      const probe_settings &settings = {})
+    -> std::vector<std::size_t>;
+
+/// Item orders are persisted next to their instance, as a count followed by
+/// the item indices in order.
+/// @{
+void write_item_order(std::ostream &stream,
+                      std::span<const std::size_t> order);
+auto read_item_order(std::istream &stream, std::size_t n_items)
+    -> std::optional<std::vector<std::size_t>>;
+/// @}
+} // namespace dlx
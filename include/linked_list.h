@@ -26,6 +26,8 @@
 
 #pragma once
 
+#include <memory_resource>
+#include <span>
 #include <vector>
 
 #include "utility.h"
@@ -103,18 +105,51 @@ public:
 private:
   const T *current;
 };
+
+template <typename T> class reverse_iterator {
+public:
+  using value_type = T;
+  using difference_type = std::uintptr_t;
+  using reference = T &;
+  using pointer = T *;
+  using iterator_category = std::input_iterator_tag;
+
+  constexpr reverse_iterator(T &node) : current{&node} {};
+
+  constexpr auto operator++() noexcept -> reverse_iterator & {
+    current = &(current->previous());
+    return *this;
+  };
+
+  constexpr bool operator!=(const reverse_iterator &other) const noexcept {
+    return other.current != current;
+  };
+
+  constexpr bool operator==(const reverse_iterator &other) const noexcept {
+    return other.current == current;
+  };
+
+  constexpr auto operator*() noexcept -> T & { return *current; };
+
+private:
+  T *current;
+};
 } // namespace
 
 //===-- linked list -----------------------------------------------------=====//
 /// Linked list that allows reversible removal and insertion of its nodes.
 template <typename T> class linked_list {
 public:
-  using iterator = iterator<T>;
-  using const_iterator = const_iterator<T>;
+  using iterator = dlx::iterator<T>;
+  using const_iterator = dlx::const_iterator<T>;
 
-  linked_list() : head{&root()}, tail{&root()} {}
+  linked_list() : tail{&root()}, head{&root()} {}
 
-  linked_list(std::size_t size) : nodes{size} {
+  linked_list(std::size_t size, std::pmr::memory_resource *resource =
+                                     std::pmr::get_default_resource())
+      : tail{&root()}, head{&root()}, nodes(size, resource) {
+    if (nodes.empty())
+      return;
     for (auto [previous, current] : stx::pairwise(nodes)) {
       previous.link_next(current);
     }
@@ -155,6 +190,16 @@ public:
     link_tail(nodes.back());
   };
 
+  /// Relinks all elements in the order given by their indices.
+  void reorder(std::span<const std::size_t> order) {
+    auto *previous = &root();
+    for (auto index : order) {
+      previous->link_next(nodes[index]);
+      previous = &nodes[index];
+    }
+    previous->link_next(root());
+  }
+
   /// Indexing directly into the vector is possible.
   /// @{
   constexpr auto operator[](std::size_t index) const -> const T & {
@@ -165,7 +210,7 @@ public:
 
 private:
   T *tail, *head;
-  std::vector<T> nodes;
+  std::pmr::vector<T> nodes;
 
   /// Returns the this pointer interpreted as a pointer to a node.
   /// @{
@@ -181,8 +226,9 @@ private:
 /// Non-owning linked list allowing reversible removal and insertion.
 template <typename T> class list_view {
 public:
-  using iterator = iterator<T>;
-  using const_iterator = const_iterator<T>;
+  using iterator = dlx::iterator<T>;
+  using const_iterator = dlx::const_iterator<T>;
+  using reverse_iterator = dlx::reverse_iterator<T>;
 
   constexpr list_view() { root().link_next(root()); };
 
@@ -202,6 +248,12 @@ public:
   constexpr auto end() noexcept { return iterator{root()}; };
   /// @}
 
+  /// Reverse iterators, traversing the linked list from back to front.
+  /// @{
+  constexpr auto rbegin() noexcept { return reverse_iterator{*tail}; };
+  constexpr auto rend() noexcept { return reverse_iterator{root()}; };
+  /// @}
+
   /// A linked list is empty if its root node is its own neighbour.
   constexpr auto empty() const noexcept -> bool {
     return head == &root();
@@ -214,17 +266,21 @@ public:
 
   /// Adds an element to the back of the linked list.
   constexpr void push_back(T &other) {
-    head->link_next(other);
+    tail->link_next(other);
     link_tail(other);
   };
 
+  /// Adds elements already linked to each other, from <first> to <last>, to
+  /// the back of the linked list.
+  constexpr void push_back(T &first, T &last) {
+    tail->link_next(first);
+    link_tail(last);
+  };
+
   /// Adds a container of elements to the back of the linked list.
   template <typename Iterable> void push_back(Iterable &nodes) {
-    for (auto &node : stx::pairwise(nodes)) {
-      previous.link_next(node);
-    }
-    link_head(nodes.front());
-    link_tail(nodes.back());
+    for (auto &node : nodes)
+      push_back(node);
   }
 
 private:
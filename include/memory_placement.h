@@ -0,0 +1,99 @@
+//===-- memory_placement.h - Memory placement -------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Huge-page backed arenas and placement of worker threads on NUMA nodes.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace dlx {
+//===-- huge page resource ------------------------------------------------===//
+/// Memory resource handing out memory from large mappings, backed by huge
+/// pages where the system provides them, to reduce TLB misses when
+/// traversing large matrices. Explicit huge pages are used if any are
+/// reserved; otherwise mappings are aligned to huge pages and advised to be
+/// backed by transparent huge pages. Like a monotonic buffer, memory is only
+/// released when the resource is destroyed. Pages are first touched, and so
+/// placed on a NUMA node, by the thread writing to them. Systems other than
+/// Linux get aligned heap allocations instead.
+class huge_page_resource : public std::pmr::memory_resource {
+public:
+  /// Size of the huge pages mappings are aligned to.
+  static constexpr std::size_t huge_page_size = std::size_t{2} << 20;
+
+  /// How the memory handed out so far is backed, in bytes.
+  struct statistics {
+    std::size_t mapped = 0;         ///< Mapped in total.
+    std::size_t explicit_pages = 0; ///< Mapped as explicit huge pages.
+    std::size_t advised = 0;        ///< Advised to use transparent huge pages.
+  };
+
+  huge_page_resource() = default;
+
+  /// Mappings are owned by the resource, which can therefore not be copied.
+  /// @{
+  huge_page_resource(const huge_page_resource &) = delete;
+  huge_page_resource &operator=(const huge_page_resource &) = delete;
+  /// @}
+
+  ~huge_page_resource() override;
+
+  auto stats() const noexcept -> statistics { return usage; }
+
+private:
+  auto do_allocate(std::size_t bytes, std::size_t alignment)
+      -> void * override;
+  void do_deallocate(void *, std::size_t, std::size_t) override {}
+  auto do_is_equal(const std::pmr::memory_resource &other) const noexcept
+      -> bool override {
+    return this == &other;
+  }
+
+  /// Maps a region of at least <bytes>, rounded up to huge pages.
+  void map(std::size_t bytes);
+
+  std::vector<std::pair<void *, std::size_t>> regions = {};
+  std::byte *current = nullptr;
+  std::size_t remaining = 0;
+  statistics usage = {};
+};
+
+//===-- thread placement --------------------------------------------------===//
+/// Returns <n_threads> CPUs the process may run on, alternating between
+/// NUMA nodes so that consecutive threads are spread over the nodes. CPUs
+/// are reused if there are fewer than <n_threads>.
+auto worker_cpus(std::size_t n_threads) -> std::vector<std::size_t>;
+
+/// Restricts the calling thread to <cpu>. Returns false if not permitted, or
+/// if the system does not support pinning threads.
+auto pin_to_cpu(std::size_t cpu) -> bool;
+
+/// Returns the NUMA node <cpu> belongs to, if the system reports it.
+auto numa_node_of(std::size_t cpu) -> std::optional<std::size_t>;
+} // namespace dlx
@@ -0,0 +1,92 @@
+//===-- mpsc_queue.h - Lock-free queue --------------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Lock-free multiple-producer single-consumer queue, used to hand results from
+/// worker threads to a single consumer.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+namespace dlx {
+//===-- mpsc queue --------------------------------------------------------===//
+/// Unbounded multiple-producer single-consumer queue after Dmitry Vyukov's
+/// intrusive design. Producers never wait on each other or on the consumer:
+/// a push is a single atomic exchange followed by a store.
+template <typename T> class mpsc_queue {
+public:
+  mpsc_queue() : head{&stub}, tail{&stub} {};
+
+  /// Queues are shared between threads by reference only.
+  /// @{
+  mpsc_queue(const mpsc_queue &) = delete;
+  mpsc_queue &operator=(const mpsc_queue &) = delete;
+  /// @}
+
+  ~mpsc_queue() {
+    while (try_pop())
+      ;
+    if (tail != &stub)
+      delete tail;
+  }
+
+  /// Appends a value to the queue. May be called from any number of threads
+  /// concurrently.
+  void push(T value) {
+    auto *node = new queue_node{std::move(value)};
+    auto *previous = head.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+  }
+
+  /// Removes the value at the front of the queue, if any. Must only be called
+  /// from the consumer thread. A push that is still in progress may not be
+  /// visible yet, in which case the queue appears empty.
+  auto try_pop() -> std::optional<T> {
+    auto *next = tail->next.load(std::memory_order_acquire);
+    if (next == nullptr)
+      return std::nullopt;
+
+    auto value = std::move(next->value);
+    if (tail != &stub)
+      delete tail;
+    tail = next; // The popped node serves as the new sentinel.
+    return value;
+  }
+
+private:
+  struct queue_node {
+    queue_node() = default;
+    queue_node(T value) : value{std::move(value)} {};
+
+    std::atomic<queue_node *> next = nullptr;
+    std::optional<T> value = {};
+  };
+
+  queue_node stub;
+  std::atomic<queue_node *> head;
+  queue_node *tail;
+};
+} // namespace dlx
@@ -0,0 +1,91 @@
+//===-- nogood_store.h - Nogood store ---------------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Bounded store of learned nogoods: sets of options that cannot all be part of
+/// an exact cover.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace dlx {
+//===-- nogood store ------------------------------------------------------===//
+/// Store of nogoods, sets of options that no exact cover contains all of.
+/// Nogoods are indexed by each of their options, so that a search can check
+/// whether selecting an option would complete one. The store is bounded by
+/// an approximate memory budget, evicting the least recently used nogoods
+/// first.
+class nogood_store {
+public:
+  /// Constructs a store using at most roughly <budget> bytes, accepting
+  /// nogoods of at most <max_size> options.
+  explicit nogood_store(std::size_t budget, std::size_t max_size = 8);
+
+  /// Records a nogood. Nogoods that are empty, too large, or already known
+  /// are ignored.
+  void learn(std::span<const std::size_t> options);
+
+  /// Returns a nogood that contains <option> and whose other options are all
+  /// flagged in <selected>, or nullptr if there is none. A nogood found is
+  /// marked as most recently used.
+  auto find(std::size_t option, const std::vector<bool> &selected)
+      -> const std::vector<std::size_t> *;
+
+  /// Statistics.
+  /// @{
+  auto size() const noexcept -> std::size_t { return nogoods.size(); }
+  auto memory() const noexcept -> std::size_t { return used; }
+  auto hits() const noexcept -> std::size_t { return found; }
+  auto evictions() const noexcept -> std::size_t { return evicted; }
+  /// @}
+
+private:
+  using entry = std::list<std::vector<std::size_t>>::iterator;
+
+  /// Hashes a sorted set of options.
+  struct hash {
+    auto operator()(const std::vector<std::size_t> &options) const noexcept
+        -> std::size_t;
+  };
+
+  /// Approximate memory used to store a nogood of a given size.
+  static auto cost(std::size_t size) -> std::size_t;
+
+  /// Removes the least recently used nogood.
+  void evict();
+
+  std::size_t budget;
+  std::size_t max_size;
+  std::size_t used = 0;
+  std::size_t found = 0;
+  std::size_t evicted = 0;
+  std::list<std::vector<std::size_t>> nogoods = {};
+  std::unordered_map<std::vector<std::size_t>, entry, hash> known = {};
+  std::unordered_map<std::size_t, std::vector<entry>> watches = {};
+};
+} // namespace dlx
@@ -0,0 +1,103 @@
+//===-- parallel_dancing_links.h - Parallel search --------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Multi-threaded search for exact covers, splitting the search tree into
+/// independent subtrees solved by separate dancing links matrices.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "dancing_links.h"
+#include "memory_placement.h"
+
+namespace dlx {
+/// Where a worker ran during a search, and how its matrix was backed.
+struct worker_placement {
+  std::optional<std::size_t> cpu = {};       ///< CPU pinned to, if pinned.
+  std::optional<std::size_t> numa_node = {}; ///< Node of that CPU.
+  huge_page_resource::statistics memory = {};
+};
+
+//===-- parallel dancing links --------------------------------------------===//
+/// Solver distributing the search for exact covers over multiple threads.
+/// The top of the search tree is expanded into prefixes of selected options,
+/// which worker threads claim one at a time and search with a private
+/// dancing links matrix. Solutions are buffered per worker and handed in
+/// batches to the consumer thread through a lock-free queue; counts are kept
+/// per worker and only summed once all workers are done. Each worker builds
+/// its matrix itself, in a huge-page backed arena, so that its pages are
+/// first touched on the worker's NUMA node.
+class parallel_dancing_links {
+public:
+  /// Constructs an exact cover problem with a given number of items, to be
+  /// solved using <n_threads> worker threads.
+  /// @{
+  parallel_dancing_links(std::size_t n_items,
+                         std::vector<std::vector<std::size_t>> sets,
+                         std::size_t n_threads = default_threads());
+  explicit parallel_dancing_links(const instance &problem,
+                                  std::size_t n_threads = default_threads());
+  /// @}
+
+  /// Searches the set of options for all subsets exactly covering all items.
+  auto solve() -> std::vector<std::vector<std::size_t>>;
+
+  /// Calls <visit> for every subset exactly covering all items. The visitor
+  /// is only ever invoked from the calling thread.
+  void enumerate(const dancing_links::visitor &visit);
+
+  /// Counts the number of subsets exactly covering all items.
+  auto count() -> std::size_t;
+
+  /// Pins each worker to its own CPU, spreading workers over the NUMA nodes,
+  /// so that its matrix stays local to it. Off by default.
+  void set_pinning(bool pin) { pinned = pin; }
+
+  /// Placement of each worker during the last search.
+  auto placements() const -> const std::vector<worker_placement> & {
+    return placement;
+  }
+
+  /// Number of worker threads used when none is specified.
+  static auto default_threads() -> std::size_t {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
+private:
+  /// Expands the top of the search tree into prefixes of selected options,
+  /// until there are enough to keep all workers busy.
+  auto split() const -> std::vector<std::vector<std::size_t>>;
+
+  std::size_t n_items;
+  std::vector<std::vector<std::size_t>> sets;
+  std::size_t n_threads;
+  bool pinned = false;
+  std::vector<worker_placement> placement = {};
+};
+} // namespace dlx
@@ -0,0 +1,58 @@
+//===-- perfect_matching.h - Perfect matchings ------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Finds and counts perfect matchings, to which exact cover reduces when every
+/// option covers two items.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace dlx {
+/// Edge of a graph with vertices numbered from zero, as a pair of endpoints.
+using edge = std::array<std::size_t, 2>;
+
+/// Returns the indices of a set of edges covering each of <vertices> vertices
+/// exactly once, or nothing if there is no such set. Uses Edmonds' blossom
+/// algorithm, which takes O(V^3) time.
+auto find_perfect_matching(std::size_t vertices, std::span<const edge> edges)
+    -> std::optional<std::vector<std::size_t>>;
+
+/// Counts the perfect matchings, counting parallel edges separately. The
+/// lowest unmatched vertex is always matched first, so that a partial
+/// matching reduces to that vertex and the set of matched vertices above it;
+/// partial matchings are merged on these, in order of the vertex. For grid
+/// graphs numbered row by row the set lies within a row of the vertex, so
+/// the time taken grows linearly with the length of the grid and only
+/// exponentially with its width. Counting gives up, returning zero, once
+/// <stop> returns true; it is called for every partial matching extended.
+auto count_perfect_matchings(std::size_t vertices, std::span<const edge> edges,
+                             const std::function<bool()> &stop = {})
+    -> std::size_t;
+} // namespace dlx
@@ -0,0 +1,101 @@
+//===-- result_cache.h - Solve result cache ---------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Cache of solve results keyed by canonical problem form.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+#include "batch_solver.h"
+#include "canonical_form.h"
+
+namespace dlx {
+//===-- result cache ------------------------------------------------------===//
+/// Bounded cache of solve results, shared between the workers of a batch
+/// solver. Results are stored for the canonical form of a problem, so that a
+/// problem that merely numbers its items or options differently is answered
+/// from the cache as well. Entries are evicted in least recently used order;
+/// if a directory is given, entries are also written there and survive the
+/// process. A result computed for all solutions answers the other modes too.
+class result_cache {
+public:
+  /// Keeps at most <capacity> results in memory, persisting them to
+  /// <directory> unless it is empty.
+  explicit result_cache(std::size_t capacity,
+                        std::filesystem::path directory = {});
+
+  /// Returns the cached result for a problem, with its solutions translated
+  /// to the problem's original option indices.
+  auto lookup(const canonical_instance &form, solve_mode mode)
+      -> std::optional<batch_result>;
+
+  /// Caches a result computed for the canonical form of a problem, that is,
+  /// with solutions in terms of the renumbered options.
+  void store(const canonical_instance &form, solve_mode mode,
+             const batch_result &result);
+
+  /// Number of lookups answered from memory or disk, and of lookups that
+  /// were not.
+  /// @{
+  auto hits() const -> std::size_t;
+  auto misses() const -> std::size_t;
+  /// @}
+
+private:
+  /// A cached result, with its problem so that hash collisions are told
+  /// apart.
+  struct entry {
+    std::uint64_t key;
+    instance problem;
+    solve_mode mode;
+    batch_result result;
+  };
+
+  /// Looks up an exact mode in memory, then on disk.
+  auto find(const canonical_instance &form, solve_mode mode)
+      -> std::optional<entry>;
+
+  /// Inserts an entry in memory, evicting the least recently used one if
+  /// the cache is full.
+  void insert(entry value);
+
+  /// Location of the file holding the entry with a given key.
+  auto path(std::uint64_t key) const -> std::filesystem::path;
+
+  std::size_t capacity;
+  std::filesystem::path directory;
+  mutable std::mutex mutex = {};
+  std::list<entry> recent = {};
+  std::unordered_map<std::uint64_t, std::list<entry>::iterator> index = {};
+  std::size_t n_hits = 0;
+  std::size_t n_misses = 0;
+};
+} // namespace dlx
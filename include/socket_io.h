@@ -0,0 +1,59 @@
+//===-- socket_io.h - Socket I/O helpers ------------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Blocking reads and writes of whole messages on sockets.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+namespace dlx::io {
+/// Owns a file descriptor, closing it when going out of scope.
+class descriptor {
+public:
+  explicit descriptor(int fd = -1) : fd{fd} {}
+  descriptor(descriptor &&other) noexcept : fd{std::exchange(other.fd, -1)} {}
+  descriptor &operator=(descriptor &&other) noexcept {
+    std::swap(fd, other.fd);
+    return *this;
+  }
+  ~descriptor();
+
+  auto get() const noexcept -> int { return fd; }
+  explicit operator bool() const noexcept { return fd >= 0; }
+
+private:
+  int fd;
+};
+
+/// Reads exactly <size> bytes, returning false on end of file or error.
+auto read_exact(int fd, std::uint8_t *data, std::size_t size) -> bool;
+
+/// Writes all of <data> to a socket. Hangups are reported as failures
+/// rather than by SIGPIPE.
+auto write_all(int fd, std::span<const std::uint8_t> data) -> bool;
+} // namespace dlx::io
@@ -0,0 +1,159 @@
+//===-- solve_server.h - Unix socket solve server ---------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Long-running server solving exact cover problems sent over a Unix domain
+/// socket.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "batch_solver.h"
+#include "instance.h"
+
+namespace dlx {
+/// Bounds on what a single request may ask of the server.
+struct server_limits {
+  /// Largest problem accepted, in items, options and request bytes.
+  /// @{
+  std::size_t max_items = std::size_t{1} << 16;
+  std::size_t max_options = std::size_t{1} << 20;
+  std::size_t max_request_bytes = std::size_t{64} << 20;
+  /// @}
+
+  /// Solutions kept and sent back at most; the count is complete unless the
+  /// search runs out of budget.
+  std::size_t max_solutions = std::size_t{1} << 16;
+
+  /// Search nodes and time a single request may take.
+  /// @{
+  std::size_t max_nodes = std::size_t{1} << 32;
+  std::chrono::milliseconds max_time = std::chrono::seconds{60};
+  /// @}
+
+  /// Connections served at once. Further clients wait in the listen backlog
+  /// until a connection closes.
+  std::size_t max_connections = 16;
+};
+
+/// Outcome of a request, as sent back to the client.
+enum class reply_status : std::uint32_t {
+  ok,        ///< All solutions asked for are included.
+  truncated, ///< More solutions exist than the server sends back.
+  malformed, ///< The request could not be decoded.
+  too_large, ///< The problem exceeds the server's limits.
+  exhausted, ///< The search ran out of budget or the server stopped; the
+             ///< count and solutions are partial.
+};
+
+/// A reply as received by a client.
+struct server_reply {
+  reply_status status = reply_status::ok;
+  std::size_t count = 0;
+  std::vector<std::vector<std::size_t>> solutions = {};
+};
+
+//===-- solve server ------------------------------------------------------===//
+/// Server accepting problems over a Unix domain socket. Each connection
+/// carries any number of requests, each being a header of three 32-bit
+/// little-endian integers (magic, solve mode and payload size) followed by a
+/// problem in the binary instance format. Problems are solved by a batch
+/// solver whose workers, with their arenas, live as long as the server.
+/// Replies start with the status, the solution count as a 64-bit integer and
+/// the number of solutions sent, followed by each solution as its size and
+/// option indices. As the count comes first, replies are only sent once the
+/// problem is solved; solutions beyond the limit are counted but not kept,
+/// so that memory use is bounded. Replies are written out in chunks as they
+/// are encoded.
+class solve_server {
+public:
+  static constexpr std::uint32_t magic = 0x51584c44; // "DLXQ"
+
+  /// Starts the solver threads and the threads serving connections.
+  explicit solve_server(std::size_t n_threads = batch_solver::default_threads(),
+                        server_limits limits = {});
+
+  /// Threads refer to the server, which cannot be relocated.
+  /// @{
+  solve_server(const solve_server &) = delete;
+  solve_server &operator=(const solve_server &) = delete;
+  /// @}
+
+  /// Stops the server if it is still running.
+  ~solve_server();
+
+  /// Listens on a socket at <path>, replacing any stale socket file there.
+  /// Returns false if the socket cannot be set up, or if some other kind of
+  /// file exists at <path>.
+  auto listen(const std::filesystem::path &path) -> bool;
+
+  /// Stops accepting connections and removes the socket file. Searches in
+  /// progress are cancelled and answered as exhausted, after which their
+  /// connections are shut down.
+  void stop();
+
+private:
+  /// Accepts connections while a connection thread is free to serve them.
+  void accept_connections();
+
+  /// Serves connections handed over by the accepting thread.
+  void serve_connections();
+
+  /// Answers the requests on a connection until the client hangs up.
+  void serve(int connection);
+
+  batch_solver solver;
+  server_limits limits;
+  std::filesystem::path socket_path = {};
+  int listener = -1;
+  std::array<int, 2> wakeup = {-1, -1};
+
+  std::mutex mutex = {};
+  std::condition_variable changed = {};
+  std::deque<int> pending = {};
+  std::unordered_set<int> active = {};
+  bool stopping = false;
+  std::atomic<bool> cancelled = false;
+
+  std::thread acceptor = {};
+  std::vector<std::thread> connection_threads = {};
+};
+
+/// Sends a single request to a server listening at <path> and waits for the
+/// reply. Returns nothing if the server cannot be reached or hangs up.
+auto request_solve(const std::filesystem::path &path, const instance &problem,
+                   solve_mode mode) -> std::optional<server_reply>;
+} // namespace dlx
@@ -0,0 +1,150 @@
+//===-- trail_dancing_links.h - Undo-trail search ---------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Exact cover search on flat index arrays, undoing modifications through a
+/// trail instead of in-place link restoration.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "dancing_links.h"
+#include "instance.h"
+
+namespace dlx {
+/// A single modification of the search state: the slot written and a value
+/// of that slot. On the trail the value is the one overwritten; in exported
+/// state it is the value to be restored.
+struct trail_entry {
+  std::uint32_t slot;
+  std::uint32_t value;
+
+  auto operator==(const trail_entry &) const -> bool = default;
+};
+
+/// State of a search at some depth, expressed as the options selected and
+/// the slots that differ from the initial state.
+struct search_state {
+  std::vector<std::size_t> selection = {};
+  std::vector<trail_entry> entries = {};
+};
+
+//===-- trail dancing links -----------------------------------------------===//
+/// Solver for the exact cover problem storing the dancing links matrix as
+/// flat arrays of 32-bit indices. Every write to the links is logged on a
+/// trail together with the overwritten value, so that any earlier depth can
+/// be restored by unwinding the trail. Since slots are indices rather than
+/// addresses, the state reached by one solver can be handed to another
+/// solver for the same problem by replaying a short list of writes.
+class trail_dancing_links {
+public:
+  /// Constructs an exact cover problem with a given number of items.
+  /// @{
+  trail_dancing_links(std::size_t n_items,
+                      const std::vector<std::vector<std::size_t>> &sets);
+  explicit trail_dancing_links(const instance &problem);
+  /// @}
+
+  /// Searches the set of options for all subsets exactly covering all items.
+  auto solve() -> std::vector<std::vector<std::size_t>>;
+
+  /// Searches the set of options for a subset exactly covering all items.
+  auto quicksolve() -> std::vector<std::size_t>;
+
+  /// Calls <visit> for every subset exactly covering all items.
+  void enumerate(const dancing_links::visitor &visit);
+
+  /// Counts the number of subsets exactly covering all items.
+  auto count() -> std::size_t;
+
+  /// Options can be selected by hand, restricting the search to subsets that
+  /// contain them.
+  void select(std::size_t option);
+
+  /// Restores the state as it was when <depth> options were selected.
+  void rollback(std::size_t depth);
+
+  /// Returns the indices of the options covering the item that the search
+  /// would branch on next, given the current selection.
+  auto candidates() const -> std::vector<std::size_t>;
+
+  /// Returns the indices of the currently selected options.
+  auto selection() const -> std::span<const std::size_t> {
+    return current_subset;
+  }
+
+  /// Number of writes on the trail.
+  auto trail_size() const -> std::size_t { return trail.size(); }
+
+  /// Returns the state as it was when <depth> options were selected, as the
+  /// writes needed to reach it from the initial state.
+  auto export_state(std::size_t depth) const -> search_state;
+
+  /// Replays a state exported by a solver for the same problem. This solver
+  /// must be in its initial state; rolling back to depth zero undoes the
+  /// import.
+  void import_state(const search_state &state);
+
+private:
+  using index = std::uint32_t;
+
+  /// Offsets into <state> are computed from item and node indices.
+  /// @{
+  auto left(index item) const -> index { return item; }
+  auto right(index item) const -> index { return n_items + 1 + item; }
+  auto size(index item) const -> index { return 2 * (n_items + 1) + item; }
+  auto up(index node) const -> index { return 3 * (n_items + 1) + node; }
+  auto down(index node) const -> index {
+    return 3 * (n_items + 1) + n_nodes + node;
+  }
+  /// @}
+
+  /// Writes a slot, logging the overwritten value on the trail.
+  void assign(index slot, index value);
+
+  /// Covers an item by hiding all options containing it.
+  void cover(index item);
+
+  /// Hides the nodes of an option other than <node> from their items.
+  void hide(index node);
+
+  /// Returns the uncovered item with the fewest options, or the root if all
+  /// items are covered.
+  auto next_candidate() const -> index;
+
+  index n_items;
+  index n_nodes;
+  std::vector<index> top = {};
+  std::vector<index> owner = {};
+  std::vector<index> first = {};
+  std::vector<index> state = {};
+  std::vector<trail_entry> trail = {};
+  std::vector<std::size_t> marks = {};
+  std::vector<std::size_t> current_subset = {};
+  std::size_t imported_depth = 0;
+};
+} // namespace dlx
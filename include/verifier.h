@@ -0,0 +1,81 @@
+//===-- verifier.h - Solution verifier --------------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Independent validation of exact covers found by any solver.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "instance.h"
+
+namespace dlx {
+//===-- verifier ----------------------------------------------------------===//
+/// Checks that proposed solutions are exact covers of a problem, without
+/// relying on any solver's data structures. Options are precompiled into
+/// (word, mask) pairs over a bitset of items, so that a solution is checked
+/// one 64-bit word at a time.
+class verifier {
+public:
+  /// Precompiles the options of a problem.
+  explicit verifier(const instance &problem);
+
+  /// Returns true if <solution> consists of valid option indices covering
+  /// every item exactly once.
+  auto check(std::span<const std::size_t> solution) const -> bool;
+
+  /// Checks a sequence of solutions on <n_threads> threads, returning the
+  /// positions of the invalid ones in increasing order.
+  auto check_all(std::span<const std::vector<std::size_t>> solutions,
+                 std::size_t n_threads = default_threads()) const
+      -> std::vector<std::size_t>;
+
+  /// Number of threads used when none is specified.
+  static auto default_threads() -> std::size_t {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
+private:
+  /// Items of an option falling into the same word of the bitset.
+  struct chunk {
+    std::size_t word;
+    std::uint64_t mask;
+  };
+
+  /// Checks a solution using <covered> as scratch space, which must be all
+  /// zeroes and is left that way.
+  auto check(std::span<const std::size_t> solution,
+             std::vector<std::uint64_t> &covered) const -> bool;
+
+  std::size_t n_items;
+  std::vector<chunk> chunks = {};
+  std::vector<std::size_t> first = {};
+  std::vector<std::size_t> weight = {};
+};
+} // namespace dlx
@@ -0,0 +1,56 @@
+//===-- wire.h - Binary encoding helpers ------------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Little-endian encoding of integers for the binary formats.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace dlx::wire {
+/// Appends an unsigned integer of <Bytes> bytes in little-endian order.
+template <std::size_t Bytes>
+void put(std::vector<std::uint8_t> &buffer, std::uint64_t value) {
+  for (std::size_t byte = 0; byte < Bytes; ++byte)
+    buffer.push_back(static_cast<std::uint8_t>(value >> (8 * byte)));
+}
+
+/// Reads an unsigned integer of <Bytes> bytes in little-endian order at
+/// <offset>, advancing it, or returns nothing if <data> is too short.
+template <std::size_t Bytes>
+auto get(std::span<const std::uint8_t> data, std::size_t &offset)
+    -> std::optional<std::uint64_t> {
+  if (data.size() - offset < Bytes || offset > data.size())
+    return std::nullopt;
+  auto value = std::uint64_t{0};
+  for (std::size_t byte = 0; byte < Bytes; ++byte)
+    value |= std::uint64_t{data[offset + byte]} << (8 * byte);
+  offset += Bytes;
+  return value;
+}
+} // namespace dlx::wire
@@ -0,0 +1,118 @@
+//===-- active_items.cpp - Dense active item sizes --------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implementation of the contiguous array of uncovered item sizes.
+///
+//===----------------------------------------------------------------------===//
+
+#include "active_items.h"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+#include <utility>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace dlx;
+
+namespace {
+#ifdef __AVX2__
+/// Loads eight consecutive sizes.
+auto load(const std::uint32_t *sizes) -> __m256i {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(sizes));
+}
+
+/// Index of the smallest of <count> sizes, the first one on ties. Reduces
+/// eight sizes per instruction to their minimum, then finds the first lane
+/// equal to it.
+auto argmin(const std::uint32_t *sizes, std::size_t count) -> std::size_t {
+  auto lanes = count / 8 * 8;
+  auto smallest = ~std::uint32_t{0};
+  if (lanes != 0) {
+    auto minima = load(sizes);
+    for (std::size_t i = 8; i < lanes; i += 8)
+      minima = _mm256_min_epu32(minima, load(sizes + i));
+    auto half = _mm_min_epu32(_mm256_castsi256_si128(minima),
+                              _mm256_extracti128_si256(minima, 1));
+    half = _mm_min_epu32(half, _mm_shuffle_epi32(half, 0b01'00'11'10));
+    half = _mm_min_epu32(half, _mm_shuffle_epi32(half, 0b10'11'00'01));
+    smallest = static_cast<std::uint32_t>(_mm_cvtsi128_si32(half));
+  }
+  for (auto i = lanes; i < count; ++i)
+    smallest = std::min(smallest, sizes[i]);
+
+  auto target = _mm256_set1_epi32(static_cast<int>(smallest));
+  for (std::size_t i = 0; i < lanes; i += 8) {
+    auto equal = _mm256_cmpeq_epi32(load(sizes + i), target);
+    auto mask = _mm256_movemask_ps(_mm256_castsi256_ps(equal));
+    if (mask != 0)
+      return i + static_cast<std::size_t>(__builtin_ctz(mask));
+  }
+  auto i = lanes;
+  while (sizes[i] != smallest)
+    ++i;
+  return i;
+}
+#else
+/// Index of the smallest of <count> sizes, the first one on ties. Compilers
+/// vectorise this scalar fallback as far as the target allows.
+auto argmin(const std::uint32_t *sizes, std::size_t count) -> std::size_t {
+  auto best = std::size_t{0};
+  for (std::size_t i = 1; i < count; ++i)
+    if (sizes[i] < sizes[best])
+      best = i;
+  return best;
+}
+#endif
+} // namespace
+
+//===-- active items ------------------------------------------------------===//
+active_items::active_items(std::size_t n_items)
+    : active{n_items}, sizes(n_items, 0), items(n_items), slots(n_items) {
+  std::iota(items.begin(), items.end(), 0);
+  std::iota(slots.begin(), slots.end(), 0);
+}
+
+/// Swaps the item with the last active one and shrinks the active range.
+void active_items::remove(std::uint32_t item) {
+  assert(slots[item] < active);
+  auto slot = slots[item];
+  auto last = static_cast<std::uint32_t>(--active);
+  std::swap(sizes[slot], sizes[last]);
+  std::swap(items[slot], items[last]);
+  slots[items[slot]] = slot;
+  slots[item] = last;
+}
+
+/// The most recently removed item sits just past the active range.
+void active_items::restore([[maybe_unused]] std::uint32_t item) {
+  assert(slots[item] == active);
+  ++active;
+}
+
+auto active_items::minimum() const -> std::uint32_t {
+  assert(active != 0);
+  return items[argmin(sizes.data(), active)];
+}
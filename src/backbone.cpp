@@ -0,0 +1,107 @@
+//===-- backbone.cpp - Backbone computation ---------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implementation of the computation of which options belong to some, and which
+/// to all exact covers.
+///
+//===----------------------------------------------------------------------===//
+
+#include "backbone.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "dancing_links.h"
+
+using namespace dlx;
+
+/// Workers claim options in index order and skip those witnessed in the
+/// meantime by any worker. Witness flags are only ever set, so relaxed
+/// atomics suffice; the join publishes them to the calling thread.
+auto dlx::compute_backbone(const instance &problem, std::size_t n_threads)
+    -> backbone {
+  auto n_options = problem.options.size();
+  auto result = backbone{};
+  result.in_some.assign(n_options, false);
+  result.in_all.assign(n_options, false);
+
+  auto first = dancing_links{problem}.quicksolve();
+  result.searches = 1;
+  // Without items, the empty selection is an exact cover.
+  if (first.empty() && problem.items != 0)
+    return result;
+
+  auto witnessed = std::make_unique<std::atomic<bool>[]>(n_options);
+  for (auto option : first)
+    witnessed[option].store(true, std::memory_order_relaxed);
+
+  auto next = std::atomic<std::size_t>{0};
+  auto searches = std::atomic<std::size_t>{0};
+  auto work = [&] {
+    auto matrix = std::unique_ptr<dancing_links>{};
+    for (auto option = next.fetch_add(1, std::memory_order_relaxed);
+         option < n_options;
+         option = next.fetch_add(1, std::memory_order_relaxed)) {
+      if (witnessed[option].load(std::memory_order_relaxed))
+        continue;
+      if (!matrix)
+        matrix = std::make_unique<dancing_links>(problem);
+      matrix->select(option);
+      for (auto member : matrix->quicksolve())
+        witnessed[member].store(true, std::memory_order_relaxed);
+      matrix->deselect();
+      searches.fetch_add(1, std::memory_order_relaxed);
+    }
+  };
+
+  n_threads = std::clamp(n_threads, std::size_t{1},
+                         std::max(n_options, std::size_t{1}));
+  if (n_threads == 1) {
+    work();
+  } else {
+    auto workers = std::vector<std::thread>{};
+    workers.reserve(n_threads);
+    for (std::size_t thread = 0; thread < n_threads; ++thread)
+      workers.emplace_back(work);
+    for (auto &worker : workers)
+      worker.join();
+  }
+  result.searches += searches.load();
+
+  // Some option covers the first item of an option in every exact cover, so
+  // the option is in all of them if no other option covering it is in any.
+  auto covering = std::vector<std::size_t>(problem.items, 0);
+  for (std::size_t option = 0; option < n_options; ++option) {
+    result.in_some[option] = witnessed[option].load();
+    if (result.in_some[option])
+      for (auto item : problem.options[option])
+        ++covering[item];
+  }
+  for (std::size_t option = 0; option < n_options; ++option) {
+    const auto &items = problem.options[option];
+    result.in_all[option] = result.in_some[option] && !items.empty() &&
+                            covering[items.front()] == 1;
+  }
+  return result;
+}
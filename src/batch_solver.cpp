@@ -0,0 +1,223 @@
+//===-- batch_solver.cpp - Batch solving ------------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implementation of the thread pool solving streams of independent exact cover
+/// problems.
+///
+//===----------------------------------------------------------------------===//
+
+#include "batch_solver.h"
+
+#include <algorithm>
+
+#include "dancing_links.h"
+#include "result_cache.h"
+
+using namespace dlx;
+
+namespace {
+/// Initial size of each worker's arena buffer.
+constexpr std::size_t initial_arena_size = std::size_t{64} << 10;
+
+/// Arena buffers are not grown beyond this size, so that a single large
+/// instance does not pin memory for the lifetime of the solver.
+constexpr std::size_t max_arena_size = std::size_t{64} << 20;
+
+/// Upstream of the worker arenas, recording how much memory an arena needed
+/// beyond its buffer so that the buffer can be grown for later instances.
+class overflow_resource : public std::pmr::memory_resource {
+public:
+  auto allocated() const noexcept -> std::size_t { return total; }
+
+private:
+  auto do_allocate(std::size_t bytes, std::size_t alignment)
+      -> void * override {
+    total += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void *pointer, std::size_t bytes,
+                     std::size_t alignment) override {
+    std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+  }
+
+  auto do_is_equal(const std::pmr::memory_resource &other) const noexcept
+      -> bool override {
+    return this == &other;
+  }
+
+  std::size_t total = 0;
+};
+
+/// Returns the nearest-rank percentile of a sorted, non-empty sample.
+auto percentile(const std::vector<std::chrono::nanoseconds> &sorted,
+                std::size_t percent) -> std::chrono::nanoseconds {
+  auto rank = (percent * sorted.size() + 99) / 100;
+  return sorted[std::max(rank, std::size_t{1}) - 1];
+}
+} // namespace
+
+//===-- batch solver ------------------------------------------------------===//
+/// Starts the worker threads, which wait for instances to be submitted.
+batch_solver::batch_solver(std::size_t n_threads) {
+  n_threads = std::max(n_threads, std::size_t{1});
+  workers.reserve(n_threads);
+  for (std::size_t i = 0; i < n_threads; ++i)
+    workers.push_back(std::make_unique<worker>());
+  for (auto &worker : workers)
+    worker->thread = std::thread{[this, &worker = *worker] { run(worker); }};
+}
+
+/// Lets the workers drain the queue before joining them.
+batch_solver::~batch_solver() {
+  {
+    auto lock = std::lock_guard{mutex};
+    stopping = true;
+  }
+  available.notify_all();
+  for (auto &worker : workers)
+    worker->thread.join();
+}
+
+/// Queues an instance, returning a future for its result.
+auto batch_solver::submit(instance problem, solve_mode mode,
+                          std::size_t max_solutions, search_budget budget)
+    -> std::future<batch_result> {
+  auto promise = std::promise<batch_result>{};
+  auto result = promise.get_future();
+  {
+    auto lock = std::lock_guard{mutex};
+    queue.push_back(
+        job{std::move(problem), mode, max_solutions, budget,
+            std::move(promise), clock::now()});
+  }
+  available.notify_one();
+  return result;
+}
+
+/// Merges the latencies recorded by each worker and computes percentiles.
+auto batch_solver::latencies() const -> latency_summary {
+  auto samples = std::vector<std::chrono::nanoseconds>{};
+  for (const auto &worker : workers) {
+    auto lock = std::lock_guard{worker->mutex};
+    samples.insert(samples.end(), worker->latencies.begin(),
+                   worker->latencies.end());
+  }
+  if (samples.empty())
+    return {};
+
+  std::sort(samples.begin(), samples.end());
+  return {samples.size(), percentile(samples, 50), percentile(samples, 90),
+          percentile(samples, 99), samples.back()};
+}
+
+/// Worker loop: takes the oldest job, solves it and fulfils its promise.
+/// Matrices are built in a monotonic arena on top of the worker's buffer and
+/// released all at once after solving.
+void batch_solver::run(worker &self) {
+  self.arena.resize(initial_arena_size);
+  while (true) {
+    auto lock = std::unique_lock{mutex};
+    available.wait(lock, [this] { return stopping || !queue.empty(); });
+    if (queue.empty())
+      return;
+    auto current = std::move(queue.front());
+    queue.pop_front();
+    lock.unlock();
+
+    try {
+      auto overflow = overflow_resource{};
+      auto result = batch_result{};
+      {
+        auto arena = std::pmr::monotonic_buffer_resource{
+            self.arena.data(), self.arena.size(), &overflow};
+        result = cache ? solve_cached(current, &arena)
+                       : solve(current.problem, current, &arena);
+      }
+      if (overflow.allocated() != 0 && self.arena.size() < max_arena_size) {
+        self.arena.resize(std::min(self.arena.size() + overflow.allocated(),
+                                   max_arena_size));
+      }
+
+      result.latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          clock::now() - current.submitted);
+      {
+        auto guard = std::lock_guard{self.mutex};
+        self.latencies.push_back(result.latency);
+      }
+      current.promise.set_value(std::move(result));
+    } catch (...) {
+      current.promise.set_exception(std::current_exception());
+    }
+  }
+}
+
+/// Solves a single instance sequentially. Exact covers beyond the limit are
+/// counted as they are found, without being copied.
+auto batch_solver::solve(const instance &problem, const job &current,
+                         std::pmr::memory_resource *resource)
+    -> batch_result {
+  auto matrix = dancing_links{problem, resource};
+  auto result = batch_result{};
+  matrix.set_budget(current.budget);
+  switch (current.mode) {
+  case solve_mode::first:
+    if (auto solution = matrix.quicksolve(); !solution.empty())
+      result.solutions.push_back(std::move(solution));
+    result.count = result.solutions.size();
+    break;
+  case solve_mode::all:
+    matrix.enumerate([&](auto solution) {
+      if (result.count++ < current.max_solutions)
+        result.solutions.emplace_back(solution.begin(), solution.end());
+    });
+    break;
+  case solve_mode::count:
+    result.count = matrix.count();
+    break;
+  }
+  result.complete = !matrix.stopped();
+  return result;
+}
+
+/// Solutions of the canonical form are translated back to the caller's
+/// option indices before returning. Results missing some exact covers are
+/// not cached, as later requests may ask for more of them.
+auto batch_solver::solve_cached(const job &current,
+                                std::pmr::memory_resource *resource)
+    -> batch_result {
+  auto mode = current.mode;
+  auto form = canonicalize(current.problem);
+  if (auto cached = cache->lookup(form, mode)) {
+    if (cached->solutions.size() > current.max_solutions)
+      cached->solutions.resize(current.max_solutions);
+    return std::move(*cached);
+  }
+
+  auto result = solve(form.problem, current, resource);
+  if (result.complete &&
+      (mode != solve_mode::all || result.solutions.size() == result.count))
+    cache->store(form, mode, result);
+  for (auto &solution : result.solutions)
+    solution = form.original(solution);
+  return result;
+}
\ No newline at end of file
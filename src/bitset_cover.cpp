@@ -0,0 +1,55 @@
+//===-- bitset_cover.cpp - Bitset exact cover -------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implementation of the word-parallel search over small exact cover problems.
+///
+//===----------------------------------------------------------------------===//
+
+#include "bitset_cover.h"
+
+#include <cassert>
+
+using namespace dlx;
+
+//===-- bitset cover ------------------------------------------------------===//
+/// Clears the options, keeping their storage for the next problem.
+void bitset_cover::reset(std::size_t n_items) {
+  assert(n_items <= max_items);
+  all = n_items == max_items ? ~std::uint64_t{0}
+                             : (std::uint64_t{1} << n_items) - 1;
+  masks.clear();
+  indices.clear();
+  for (std::size_t item = 0; item < used; ++item)
+    containing[item].clear();
+  used = n_items;
+}
+
+/// Lists the option under each of its items.
+void bitset_cover::add_option(std::uint64_t mask, std::size_t index) {
+  assert((mask & ~all) == 0);
+  auto option = static_cast<std::uint32_t>(masks.size());
+  masks.push_back(mask);
+  indices.push_back(index);
+  for (; mask != 0; mask &= mask - 1)
+    containing[static_cast<std::size_t>(std::countr_zero(mask))].push_back(
+        option);
+}
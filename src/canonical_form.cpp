@@ -0,0 +1,225 @@
+//===-- canonical_form.cpp - Canonical problem form -------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implementation of the canonical relabelling of exact cover problems.
+///
+//===----------------------------------------------------------------------===//
+
+#include "canonical_form.h"
+
+#include <algorithm>
+#include <numeric>
+#include <optional>
+#include <unordered_set>
+
+using namespace dlx;
+
+namespace {
+/// Finaliser of splitmix64, spreading the bits of <value> over the result.
+auto mix(std::uint64_t value) -> std::uint64_t {
+  value ^= value >> 30;
+  value *= 0xbf58476d1ce4e5b9;
+  value ^= value >> 27;
+  value *= 0x94d049bb133111eb;
+  return value ^ (value >> 31);
+}
+
+/// Order-dependent combination of hashes.
+auto combine(std::uint64_t seed, std::uint64_t value) -> std::uint64_t {
+  return mix(seed ^ (value + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2)));
+}
+
+/// Hash of a multiset of colours, independent of their order.
+auto multiset(std::uint64_t seed, std::vector<std::uint64_t> &colours)
+    -> std::uint64_t {
+  std::sort(colours.begin(), colours.end());
+  for (auto colour : colours)
+    seed = combine(seed, colour);
+  return seed;
+}
+
+auto distinct(const std::vector<std::uint64_t> &colours) -> std::size_t {
+  return std::unordered_set<std::uint64_t>(colours.begin(), colours.end())
+      .size();
+}
+
+/// Leaves of the search tree visited before settling for the best form
+/// found so far.
+constexpr std::size_t max_leaves = 64;
+
+/// A numbering of the options of a problem, with the options relabelled by
+/// the canonical item numbers, and the canonical number of each item.
+struct labelling {
+  std::vector<std::vector<std::size_t>> options = {};
+  std::vector<std::size_t> order = {};
+  std::vector<std::size_t> items = {};
+};
+
+/// Individualisation-refinement search for the smallest relabelled problem:
+/// colours are refined until stable, and while some items share a colour,
+/// each item of the smallest such colour is given a colour of its own in
+/// turn. Every leaf colours all items differently, which numbers them.
+class canonical_search {
+public:
+  explicit canonical_search(const instance &problem)
+      : problem{problem}, containing(problem.items) {
+    for (std::size_t option = 0; option < problem.options.size(); ++option)
+      for (auto item : problem.options[option])
+        containing[item].push_back(option);
+  }
+
+  auto run() -> labelling {
+    auto items = std::vector<std::uint64_t>(problem.items);
+    for (std::size_t item = 0; item < problem.items; ++item)
+      items[item] = mix(containing[item].size());
+    search(items);
+    return std::move(best);
+  }
+
+private:
+  /// Recolours items by the colours of their options until the number of
+  /// distinct colours stops growing.
+  void refine(std::vector<std::uint64_t> &items) {
+    auto options = std::vector<std::uint64_t>(problem.options.size());
+    for (auto classes = distinct(items);;) {
+      for (std::size_t option = 0; option < options.size(); ++option) {
+        scratch.clear();
+        for (auto item : problem.options[option])
+          scratch.push_back(items[item]);
+        options[option] = multiset(0, scratch);
+      }
+      auto refined = items;
+      for (std::size_t item = 0; item < problem.items; ++item) {
+        scratch.clear();
+        for (auto option : containing[item])
+          scratch.push_back(options[option]);
+        refined[item] = multiset(items[item], scratch);
+      }
+      auto refined_classes = distinct(refined);
+      if (refined_classes == classes)
+        return;
+      items = std::move(refined);
+      classes = refined_classes;
+    }
+  }
+
+  void search(std::vector<std::uint64_t> items) {
+    refine(items);
+    auto shared = shared_colour(items);
+    if (!shared) {
+      leaf(items);
+      return;
+    }
+    for (std::size_t item = 0; item < problem.items; ++item) {
+      if (items[item] != *shared || leaves == max_leaves)
+        continue;
+      auto individualised = items;
+      individualised[item] = combine(items[item], problem.items + 1);
+      search(std::move(individualised));
+    }
+  }
+
+  /// Smallest colour shared by several items, if any.
+  auto shared_colour(const std::vector<std::uint64_t> &items) const
+      -> std::optional<std::uint64_t> {
+    auto sorted = items;
+    std::sort(sorted.begin(), sorted.end());
+    auto shared = std::adjacent_find(sorted.begin(), sorted.end());
+    if (shared == sorted.end())
+      return std::nullopt;
+    return *shared;
+  }
+
+  /// Numbers the items by colour and keeps the relabelled problem if it is
+  /// the smallest so far.
+  void leaf(const std::vector<std::uint64_t> &items) {
+    ++leaves;
+    auto order = std::vector<std::size_t>(problem.items);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](auto left, auto right) {
+      return items[left] < items[right];
+    });
+    auto renumbered = std::vector<std::size_t>(problem.items);
+    for (std::size_t position = 0; position < order.size(); ++position)
+      renumbered[order[position]] = position;
+
+    auto relabelled = std::vector<std::vector<std::size_t>>{};
+    relabelled.reserve(problem.options.size());
+    for (const auto &option : problem.options) {
+      auto &items_of = relabelled.emplace_back();
+      for (auto item : option)
+        items_of.push_back(renumbered[item]);
+      std::sort(items_of.begin(), items_of.end());
+    }
+
+    auto current = labelling{{}, std::vector<std::size_t>(relabelled.size()),
+                             std::move(renumbered)};
+    std::iota(current.order.begin(), current.order.end(), 0);
+    std::stable_sort(current.order.begin(), current.order.end(),
+                     [&](auto left, auto right) {
+                       return relabelled[left] < relabelled[right];
+                     });
+    current.options.reserve(relabelled.size());
+    for (auto option : current.order)
+      current.options.push_back(std::move(relabelled[option]));
+
+    if (leaves == 1 || current.options < best.options)
+      best = std::move(current);
+  }
+
+  const instance &problem;
+  std::vector<std::vector<std::size_t>> containing;
+  std::vector<std::uint64_t> scratch = {};
+  labelling best = {};
+  std::size_t leaves = 0;
+};
+} // namespace
+
+//===-- canonical form ----------------------------------------------------===//
+auto canonical_instance::original(std::span<const std::size_t> solution) const
+    -> std::vector<std::size_t> {
+  auto result = std::vector<std::size_t>{};
+  result.reserve(solution.size());
+  for (auto option : solution)
+    result.push_back(options[option]);
+  return result;
+}
+
+/// Relabels the problem by the smallest labelling found, and hashes it.
+/// Positions of cells are carried over to the renumbered items, but are not
+/// hashed, as they do not change the exact covers.
+auto dlx::canonicalize(const instance &problem) -> canonical_instance {
+  auto best = canonical_search{problem}.run();
+  auto form = canonical_instance{{problem.items, std::move(best.options)},
+                                 std::move(best.order), mix(problem.items)};
+  if (!problem.cells.empty()) {
+    form.problem.cells.resize(problem.items);
+    for (std::size_t item = 0; item < problem.items; ++item)
+      form.problem.cells[best.items[item]] = problem.cells[item];
+  }
+  for (const auto &option : form.problem.options) {
+    form.hash = combine(form.hash, option.size());
+    for (auto item : option)
+      form.hash = combine(form.hash, item);
+  }
+  return form;
+}
@@ -0,0 +1,181 @@
+//===-- cnf.cpp - CNF export ------------------------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implementation of the conversion between exact cover problems and DIMACS
+/// CNF.
+///
+//===----------------------------------------------------------------------===//
+
+#include "cnf.h"
+
+#include <cassert>
+#include <charconv>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+using namespace dlx;
+
+namespace {
+/// Writes literals through a local buffer, formatting with <to_chars>, so
+/// that large instances are not bottlenecked on stream insertion.
+class clause_writer {
+public:
+  explicit clause_writer(std::ostream &stream) : stream{stream} {
+    buffer.reserve(capacity + 32);
+  }
+
+  ~clause_writer() { flush(); }
+
+  /// Writes a literal, followed by a space.
+  void literal(long long value) {
+    char digits[24];
+    auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    buffer.append(digits, end);
+    buffer.push_back(' ');
+  }
+
+  /// Terminates the current clause.
+  void end() {
+    buffer.append("0\n");
+    if (buffer.size() >= capacity)
+      flush();
+  }
+
+  /// Writes a clause of two literals.
+  void clause(long long first, long long second) {
+    literal(first);
+    literal(second);
+    end();
+  }
+
+  void flush() {
+    stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+  }
+
+private:
+  static constexpr std::size_t capacity = std::size_t{1} << 16;
+
+  std::ostream &stream;
+  std::string buffer = {};
+};
+
+/// Variable of the option a node belongs to.
+auto variable(node &node) -> long long {
+  return static_cast<long long>(node.parent_option().get_index()) + 1;
+}
+} // namespace
+
+/// Counts variables and clauses from the item sizes alone, then writes the
+/// clauses item by item. Sinz's sequential counter over x_1..x_k uses
+/// auxiliary s_1..s_k-1 meaning "one of x_1..x_j is true", with clauses
+/// x_j -> s_j, s_j-1 -> s_j and x_j -> !s_j-1.
+void dlx::write_cnf(std::ostream &stream, dancing_links &problem,
+                    const cnf_settings &settings) {
+  assert(problem.selection().empty());
+
+  auto variables = problem.option_count();
+  auto clauses = std::size_t{0};
+  for (std::size_t item = 0; item < problem.item_count(); ++item) {
+    auto size = problem.column(item).size();
+    clauses += 1;
+    if (size <= settings.pairwise_limit) {
+      clauses += size * (size - (size > 0)) / 2;
+    } else {
+      variables += size - 1;
+      clauses += 3 * size - 4;
+    }
+  }
+  stream << "p cnf " << variables << ' ' << clauses << '\n';
+
+  auto writer = clause_writer{stream};
+  auto next = static_cast<long long>(problem.option_count()) + 1;
+  for (std::size_t item = 0; item < problem.item_count(); ++item) {
+    auto &column = problem.column(item);
+    for (auto &node : column)
+      writer.literal(variable(node));
+    writer.end();
+
+    auto size = column.size();
+    if (size <= settings.pairwise_limit) {
+      for (auto first = column.begin(); first != column.end(); ++first) {
+        auto second = first;
+        for (++second; second != column.end(); ++second)
+          writer.clause(-variable(*first), -variable(*second));
+      }
+      continue;
+    }
+
+    auto previous = 0ll;
+    auto position = std::size_t{0};
+    for (auto &node : column) {
+      auto x = variable(node);
+      auto last = ++position == size;
+      if (previous != 0)
+        writer.clause(-x, -previous);
+      if (last)
+        break;
+      auto counter = next++;
+      writer.clause(-x, counter);
+      if (previous != 0)
+        writer.clause(-previous, counter);
+      previous = counter;
+    }
+  }
+}
+
+/// Scans the output for a status line and literals. Lines starting with 'c'
+/// are comments; the literals of "v" lines, or of lines consisting only of
+/// literals, make up the model.
+auto dlx::read_sat_model(std::istream &stream, std::size_t n_options)
+    -> std::optional<std::vector<std::size_t>> {
+  auto model = std::vector<std::size_t>{};
+  auto seen = false;
+  auto line = std::string{};
+  while (std::getline(stream, line)) {
+    auto tokens = std::istringstream{line};
+    auto first = std::string{};
+    if (!(tokens >> first) || first == "c")
+      continue;
+    if (first == "UNSAT" || first == "UNSATISFIABLE" ||
+        (first == "s" && line.find("UNSATISFIABLE") != std::string::npos))
+      return std::nullopt;
+    if (first == "s" || first == "SAT" || first == "SATISFIABLE")
+      continue;
+    if (first != "v")
+      tokens = std::istringstream{line};
+
+    auto literal = 0ll;
+    while (tokens >> literal) {
+      seen = true;
+      if (literal > 0 && static_cast<std::size_t>(literal) <= n_options)
+        model.push_back(static_cast<std::size_t>(literal) - 1);
+    }
+    if (!tokens.eof())
+      return std::nullopt;
+  }
+  if (!seen)
+    return std::nullopt;
+  return model;
+}
@@ -29,9 +29,77 @@
 
 #include <algorithm>
 #include <cassert>
+#include <thread>
+#include <type_traits>
+#include <utility>
 
 using namespace dlx;
 
+namespace {
+/// Calls <f> on the indices 0 to Width - 1 in order, or in reverse order if
+/// <Reverse> is set, as compile-time constants.
+template <std::size_t Width, bool Reverse = false, typename F>
+void unrolled(F &&f) {
+  [&]<std::size_t... I>(std::index_sequence<I...>) {
+    (f(std::integral_constant<std::size_t,
+                              Reverse ? Width - 1 - I : I>{}),
+     ...);
+  }(std::make_index_sequence<Width>{});
+}
+
+/// Calls <f> with the width of the options as a compile-time constant if it
+/// is small enough to be unrolled, or with zero otherwise.
+template <typename F> auto with_width(std::size_t width, F &&f) {
+  switch (width) {
+  case 1: return f(std::integral_constant<std::size_t, 1>{});
+  case 2: return f(std::integral_constant<std::size_t, 2>{});
+  case 3: return f(std::integral_constant<std::size_t, 3>{});
+  case 4: return f(std::integral_constant<std::size_t, 4>{});
+  case 5: return f(std::integral_constant<std::size_t, 5>{});
+  case 6: return f(std::integral_constant<std::size_t, 6>{});
+  case 7: return f(std::integral_constant<std::size_t, 7>{});
+  case 8: return f(std::integral_constant<std::size_t, 8>{});
+  default: return f(std::integral_constant<std::size_t, 0>{});
+  }
+}
+static_assert(dancing_links::max_unrolled == 8);
+
+/// Hints the processor to fetch the cache line holding <address> in
+/// preparation for a write, if built with DLX_PREFETCH.
+inline void prefetch([[maybe_unused]] const void *address) {
+#if defined(DLX_PREFETCH) && (defined(__GNUC__) || defined(__clang__))
+  __builtin_prefetch(address, 1, 3);
+#endif
+}
+
+/// Prefetches what removing or reinserting <node> writes to: the link fields
+/// of its neighbours and the size of its item.
+inline void prefetch_neighbours(node &node) {
+  prefetch(&node.previous());
+  prefetch(&node.next());
+  prefetch(&node.parent_item());
+}
+
+/// Prefetches the node after <node> in its column, and the nodes of its
+/// option, whose neighbours are written to when the option is hidden.
+inline void prefetch_option(node &node) {
+  prefetch(&node.next());
+  auto nodes = node.parent_option().nodes();
+  prefetch(nodes.data());
+  prefetch(nodes.data() + nodes.size() - 1);
+}
+
+/// Runs <task> for each thread index on its own thread.
+template <typename Task> void in_parallel(std::size_t n_threads, Task task) {
+  auto workers = std::vector<std::thread>{};
+  workers.reserve(n_threads);
+  for (std::size_t thread = 0; thread < n_threads; ++thread)
+    workers.emplace_back(task, thread);
+  for (auto &worker : workers)
+    worker.join();
+}
+} // namespace
+
 //===-- node --------------------------------------------------------------===//
 /// Constructor for a normal node denoting an item in an option.
 node::node(item &top, option &owner)
@@ -39,17 +107,21 @@ node::node(item &top, option &owner)
   top.add_node(*this);
 };
 
+/// Creates a node without adding it to its item's list.
+node::node(item &top, option &owner, unlinked_t)
+    : up{nullptr}, down{nullptr}, top{top}, owner{owner} {}
+
 /// Covers the item covered by this node.
 void node::cover() { top.cover(); }
 
 /// Uncovers the item covered by this node.
 void node::uncover() { top.uncover(); }
 
-/// Hides the option of which this node is part.
-void node::hide() { owner.hide(); }
+/// Hides the other nodes of the option of which this node is part.
+void node::hide() { owner.hide(*this); }
 
-/// Unhides the option of which this node is part.
-void node::unhide() { owner.unhide(); }
+/// Unhides the other nodes of the option of which this node is part.
+void node::unhide() { owner.unhide(*this); }
 
 /// A node can remove itself from its linked list by rewiring its neighbours.
 /// Removal is reversible because it does not reset the removed node's
@@ -83,37 +155,109 @@ void node::link_next(node &other) {
 //===-- option ------------------------------------------------------------===//
 /// Creates an option covering the specified items in <items>.
 option::option(std::size_t index, linked_list<item> &items,
-               std::initializer_list<std::size_t> set)
-    : index{index} {
+               std::initializer_list<std::size_t> set,
+               std::pmr::memory_resource *resource)
+    : option{index, items, std::vector<std::size_t>(set), resource} {}
+
+/// Creates an option covering the specified items in <items>.
+option::option(std::size_t index, linked_list<item> &items,
+               const std::vector<std::size_t> &set,
+               std::pmr::memory_resource *resource)
+    : covered{resource}, index{index} {
   covered.reserve(set.size());
   for (auto item : set) {
     covered.emplace_back(items[item], *this);
   }
 }
 
+/// Creates an option whose nodes are still to be added to their items.
+option::option(std::size_t index, linked_list<item> &items,
+               const std::vector<std::size_t> &set, unlinked_t,
+               std::pmr::memory_resource *resource)
+    : covered{resource}, index{index} {
+  covered.reserve(set.size());
+  for (auto item : set) {
+    covered.emplace_back(items[item], *this, unlinked);
+  }
+}
+
 /// Hides an option from the candidate solution set.
-void option::hide() {
-  for (auto &node : covered)
-    node.remove();
+void option::hide(const node &except) { hide<0>(except); }
+
+/// Unhides an option from the candidate solution set, reinserting its nodes
+/// in the reverse order of their removal.
+void option::unhide(const node &except) { unhide<0>(except); }
+
+/// Covers all items covered by this option.
+void option::cover() { cover<0>(); }
+
+/// Uncovers all items covered by this option, in the reverse order of
+/// covering.
+void option::uncover() { uncover<0>(); }
+
+/// The neighbours of each node are prefetched one node ahead, so that their
+/// cache misses overlap with the removal of the node before.
+template <std::size_t Width> void option::hide(const node &except) {
+  if constexpr (Width == 0) {
+    auto *nodes = covered.data();
+    for (std::size_t i = 0; i < covered.size(); ++i) {
+      if (i + 1 < covered.size())
+        prefetch_neighbours(nodes[i + 1]);
+      if (&nodes[i] != &except)
+        nodes[i].remove();
+    }
+  } else {
+    assert(covered.size() == Width);
+    auto *nodes = covered.data();
+    unrolled<Width>([&](auto i) {
+      if constexpr (i + 1 < Width)
+        prefetch_neighbours(nodes[i + 1]);
+      if (&nodes[i] != &except)
+        nodes[i].remove();
+    });
+  }
 }
 
-/// Unhides an option from the candidate solution set.
-void option::unhide() {
-  for (auto &node : covered)
-    node.reinsert();
+template <std::size_t Width> void option::unhide(const node &except) {
+  if constexpr (Width == 0) {
+    auto *nodes = covered.data();
+    for (auto i = covered.size(); i-- > 0;) {
+      if (i > 0)
+        prefetch_neighbours(nodes[i - 1]);
+      if (&nodes[i] != &except)
+        nodes[i].reinsert();
+    }
+  } else {
+    auto *nodes = covered.data();
+    unrolled<Width, true>([&](auto i) {
+      if constexpr (i > 0)
+        prefetch_neighbours(nodes[i - 1]);
+      if (&nodes[i] != &except)
+        nodes[i].reinsert();
+    });
+  }
 }
 
-/// Covers all items covered by this option.
-void option::cover() {
-  for (auto &node : covered) {
-    node.cover();
+template <std::size_t Width> void option::cover() {
+  if constexpr (Width == 0) {
+    for (auto &node : covered)
+      node.parent_item().cover<Width>();
+  } else {
+    auto *nodes = covered.data();
+    unrolled<Width>(
+        [&](auto i) { nodes[i].parent_item().template cover<Width>(); });
   }
 }
 
-/// Uncovers all items covered by this option.
-void option::uncover() {
-  for (auto &node : covered)
-    node.uncover();
+template <std::size_t Width> void option::uncover() {
+  if constexpr (Width == 0) {
+    for (auto node = covered.rbegin(); node != covered.rend(); ++node)
+      node->parent_item().uncover<Width>();
+  } else {
+    auto *nodes = covered.data();
+    unrolled<Width, true>(
+        [&](auto i) { nodes[i].parent_item().template uncover<Width>(); });
+  }
 }
 
 //===-- item --------------------------------------------------------------===//
@@ -121,18 +265,38 @@ void option::uncover() {
 /// part of the candidate solution set, removing all options containing this
 /// item from the solution set.
 /// Covering is reversible.
-void item::cover() {
-  for (auto &option : options)
-    option.hide();
-  this->remove();
-}
+void item::cover() { cover<0>(); }
 
 /// Reverts the covering of an option, adding it back into the candidate
 /// solution set, effectively walking one step back up the search tree.
-void item::uncover() {
+/// Options are unhidden in the reverse order of hiding.
+void item::uncover() { uncover<0>(); }
+
+/// While hiding the option of a node, the option of the next node in the
+/// column and the node after it are prefetched, so that walking the column
+/// does not stall on a chain of dependent misses.
+template <std::size_t Width> void item::cover() {
+  for (auto node = options.begin(); node != options.end();) {
+    auto &current = *node;
+    if (++node != options.end())
+      prefetch_option(*node);
+    current.parent_option().hide<Width>(current);
+  }
+  this->remove();
+  if (dense)
+    dense->remove(id);
+}
+
+template <std::size_t Width> void item::uncover() {
+  if (dense)
+    dense->restore(id);
   this->reinsert();
-  for (auto &option : options)
-    option.unhide();
+  for (auto node = options.rbegin(); node != options.rend();) {
+    auto &current = *node;
+    if (++node != options.rend())
+      prefetch_option(*node);
+    current.parent_option().unhide<Width>(current);
+  }
 }
 
 /// An item can remove itself from its linked list by rewiring its neighbours.
@@ -147,7 +311,7 @@ void item::remove() const {
 /// neighbouring nodes.
 void item::reinsert() {
   this->left->right = this;
-  this->left->right = this;
+  this->right->left = this;
 }
 
 /// Links another item to be the left neighbour of this item.
@@ -162,31 +326,178 @@ void item::link_next(item &other) {
   other.left = this;
 }
 
+/// Starts or stops mirroring this item into a dense array.
+void item::track(active_items *active, std::uint32_t index) {
+  dense = active;
+  id = index;
+  if (dense)
+    dense->resize(id, static_cast<std::uint32_t>(size));
+}
+
 /// Adds a node to the end of the item list.
 void item::add_node(node &node) {
   options.push_back(node);
   size += 1;
 }
 
+/// Adds <count> nodes, linked from <first> to <last>, to the end of the item
+/// list.
+void item::add_nodes(node &first, node &last, std::size_t count) {
+  options.push_back(first, last);
+  size += count;
+}
+
 //===-- dancing links -----------------------------------------------------===//
 /// Constructs an exact cover problem with a given number of items.
 dancing_links::dancing_links(
     std::size_t n_items,
     std::initializer_list<std::initializer_list<std::size_t>> sets)
-    : items{n_items} {
+    : dancing_links{n_items,
+                    std::vector<std::vector<std::size_t>>(sets.begin(),
+                                                          sets.end())} {}
+
+/// Constructs an exact cover problem from option sets only known at runtime.
+dancing_links::dancing_links(
+    std::size_t n_items, const std::vector<std::vector<std::size_t>> &sets,
+    std::pmr::memory_resource *resource)
+    : dancing_links{n_items, sets, resource, 1} {}
+
+/// Constructs the exact cover problem described by an instance.
+dancing_links::dancing_links(const instance &problem,
+                             std::pmr::memory_resource *resource)
+    : dancing_links{problem.items, problem.options, resource} {
+  sweep = plan_sweep(problem);
+}
+
+/// Constructs the exact cover problem described by an instance on a given
+/// number of threads.
+dancing_links::dancing_links(const instance &problem, std::size_t n_threads,
+                             std::pmr::memory_resource *resource)
+    : dancing_links{problem.items, problem.options, resource,
+                    std::max(n_threads, std::size_t{1})} {
+  sweep = plan_sweep(problem);
+}
+
+/// Options are allocated on the calling thread, as <resource> need not be
+/// thread-safe. On one thread, nodes are added to their items as they are
+/// created; otherwise they are linked afterwards.
+dancing_links::dancing_links(
+    std::size_t n_items, const std::vector<std::vector<std::size_t>> &sets,
+    std::pmr::memory_resource *resource, std::size_t n_threads)
+    : n_items{n_items}, items{n_items, resource}, options{resource},
+      current_subset{resource},
+      forced{resource} {
   options.reserve(sets.size());
-  for (const auto set : sets) {
-    options.emplace_back(options.size(), items, set);
+  if (n_threads == 1) {
+    for (const auto &set : sets)
+      options.emplace_back(options.size(), items, set, resource);
+  } else {
+    for (const auto &set : sets)
+      options.emplace_back(options.size(), items, set, unlinked, resource);
+    link_columns(n_threads);
+  }
+
+  for (const auto &set : sets)
+    longest = std::max(longest, set.size());
+  if (!sets.empty()) {
+    width = sets.front().size();
+    auto uniform = [&](const auto &set) { return set.size() == width; };
+    if (!std::all_of(sets.begin(), sets.end(), uniform))
+      width = 0;
+  }
+  if (width == 2) {
+    for (const auto &set : sets) {
+      edges.push_back({set[0], set[1]});
+      edge_reach = std::max(edge_reach, set[0] > set[1] ? set[0] - set[1]
+                                                        : set[1] - set[0]);
+    }
   }
 }
 
-/// Recursively searches the set of options to find all subsets exactly
-/// covering all given items. Resulting covering subsets are stored in
-/// <solutions>.
+/// Each thread first links the nodes of a contiguous range of options into
+/// partial lists per item, in option order, counting the nodes of each item.
+/// The partial lists of an item are then joined in thread order, so that
+/// nodes end up in each item's list in option order, as when linked one at a
+/// time. Linking while passing over the options keeps the writes to the
+/// nodes sequential, unlike linking column by column.
+void dancing_links::link_columns(std::size_t n_threads) {
+  auto slice = [n_threads](std::size_t size, std::size_t thread) {
+    return std::pair{size * thread / n_threads,
+                     size * (thread + 1) / n_threads};
+  };
+
+  // Partial list of each item in the options of each thread, row by row.
+  struct partial {
+    node *first = nullptr;
+    node *last = nullptr;
+    std::size_t count = 0;
+  };
+  auto partials = std::vector<partial>(n_threads * n_items);
+  in_parallel(n_threads, [&](std::size_t thread) {
+    auto [begin, end] = slice(options.size(), thread);
+    auto *row = partials.data() + thread * n_items;
+    for (auto index = begin; index < end; ++index) {
+      for (auto &node : options[index].nodes()) {
+        auto &column = row[index_of(node.parent_item())];
+        if (column.last)
+          column.last->link_next(node);
+        else
+          column.first = &node;
+        column.last = &node;
+        ++column.count;
+      }
+    }
+  });
+
+  in_parallel(n_threads, [&](std::size_t thread) {
+    auto [begin, end] = slice(n_items, thread);
+    for (auto item = begin; item < end; ++item) {
+      for (std::size_t row = 0; row < n_threads; ++row) {
+        auto &column = partials[row * n_items + item];
+        if (column.count != 0)
+          items[item].add_nodes(*column.first, *column.last, column.count);
+      }
+    }
+  });
+}
+
+/// Searches the set of options to find all subsets exactly covering all given
+/// items. Resulting covering subsets are stored in <solutions>.
 auto dancing_links::solve() -> std::vector<std::vector<std::size_t>> {
+  enumerate([this](auto subset) {
+    solutions.emplace_back(subset.begin(), subset.end());
+  });
+  return solutions;
+}
+
+/// Searches the set of options to find a subset exactly covering all given
+/// items, extending the current selection.
+auto dancing_links::quicksolve() -> std::vector<std::size_t> {
+  if (matches())
+    return find_perfect_matching(n_items, edges).value_or(
+        std::vector<std::size_t>{});
+  return with_width(width, [this](auto w) { return find<w>(); });
+}
+
+/// Recursively searches the set of options to find a subset exactly
+/// covering all given items.
+template <std::size_t Width>
+auto dancing_links::find() -> std::vector<std::size_t> {
   if (this->exact_cover()) {
-    solutions.emplace_back(current_subset);
-    return solutions;
+    return {current_subset.begin(), current_subset.end()};
+  }
+  if (out_of_budget())
+    return {};
+
+  if (bitset_threshold != 0 && compact()) {
+    auto depth = current_subset.size();
+    auto result = std::vector<std::size_t>{};
+    residual.search(residual.all_items(), current_subset, [&] {
+      result.assign(current_subset.begin(), current_subset.end());
+      return true;
+    });
+    current_subset.resize(depth);
+    return result;
   }
 
   auto &item = next_candidate();
@@ -195,41 +506,388 @@ auto dancing_links::solve() -> std::vector<std::vector<std::size_t>> {
     return {};
   }
 
+  const auto lookahead = looks_ahead();
   for (auto &node : item.covering_options()) {
     auto &option = node.parent_option();
-    current_subset.emplace_back(option.get_index());
-    option.cover();
-    solve();
-    option.uncover();
+    if (lookahead && !consistent(option))
+      continue;
+    current_subset.push_back(option.get_index());
+    option.cover<Width>();
+    auto result = find<Width>();
+    option.uncover<Width>();
     current_subset.pop_back();
+    if (!result.empty() || halted)
+      return result;
   }
-  return solutions;
+  return {};
 }
 
-/// Recursively searches the set of options to find a subset exactly
-/// covering all given items.
-auto dancing_links::quicksolve() -> std::vector<std::size_t> {
+/// Searches the set of options to find all subsets exactly covering all given
+/// items, extending the current selection.
+void dancing_links::enumerate(const visitor &visit) {
+  if (nogoods == nullptr) {
+    with_width(width, [&](auto w) { search<w>(visit); });
+    return;
+  }
+  auto conflict = std::vector<std::size_t>{};
+  learn(visit, conflict);
+}
+
+/// Recursively searches the set of options to find all subsets exactly
+/// covering all given items, extending the current selection.
+template <std::size_t Width>
+void dancing_links::search(const visitor &visit) {
   if (this->exact_cover()) {
-    return current_subset;
+    visit(current_subset);
+    return;
+  }
+  if (out_of_budget())
+    return;
+
+  if (bitset_threshold != 0 && compact()) {
+    residual.search(residual.all_items(), current_subset, [&] {
+      visit(current_subset);
+      return false;
+    });
+    return;
   }
 
   auto &item = next_candidate();
 
   if (!item.satisfiable()) { // Current subset is invalid
-    return {};
+    return;
   }
 
+  const auto lookahead = looks_ahead();
   for (auto &node : item.covering_options()) {
     auto &option = node.parent_option();
+    if (lookahead && !consistent(option))
+      continue;
     current_subset.push_back(option.get_index());
+    option.cover<Width>();
+    search<Width>(visit);
+    option.uncover<Width>();
+    current_subset.pop_back();
+    if (halted)
+      return;
+  }
+}
+
+/// Counts all subsets exactly covering all given items.
+auto dancing_links::count() -> std::size_t {
+  auto stop = [this] { return out_of_budget(); };
+  if (sweeps() && (!matches() || sweep->reach < edge_reach))
+    return count_by_sweep(*sweep, stop);
+  if (matches())
+    return count_perfect_matchings(n_items, edges, stop);
+  auto total = std::size_t{0};
+  enumerate([&total](auto) { ++total; });
+  return total;
+}
+
+/// Perfect matchings and sweeps need not consider the selection, or the
+/// pruning and learning done by the search.
+auto dancing_links::plain() const -> bool {
+  return current_subset.empty() && lookahead_depths.empty() &&
+         nogoods == nullptr;
+}
+
+auto dancing_links::matches() const -> bool {
+  return matching && width == 2 && plain();
+}
+
+auto dancing_links::sweeps() const -> bool {
+  return sweeping && sweep && plain();
+}
+
+void dancing_links::set_budget(search_budget budget) {
+  this->budget = budget;
+  spent = 0;
+  halted = false;
+}
+
+auto dancing_links::out_of_budget() -> bool {
+  if (halted)
+    return true;
+  if (++spent > budget.nodes) {
+    halted = true;
+  } else if (spent % budget_interval == 0) {
+    halted = std::chrono::steady_clock::now() >= budget.deadline ||
+             (budget.cancelled != nullptr &&
+              budget.cancelled->load(std::memory_order_relaxed));
+  }
+  return halted;
+}
+
+/// Selects an option as part of the candidate solution, covering its items.
+/// The option must not conflict with the current selection.
+void dancing_links::select(std::size_t index) { choose(options[index]); }
+
+/// Undoes the most recent selection.
+void dancing_links::deselect() {
+  assert(!current_subset.empty());
+  unchoose(options[current_subset.back()]);
+}
+
+/// Returns the indices of the options covering the next item to be covered.
+/// The result is empty if the current selection is an exact cover, or if it
+/// cannot be extended into one.
+auto dancing_links::candidates() -> std::vector<std::size_t> {
+  if (this->exact_cover())
+    return {};
+
+  auto result = std::vector<std::size_t>{};
+  for (auto &node : next_candidate().covering_options())
+    result.push_back(node.parent_option().get_index());
+  return result;
+}
+
+/// Builds or drops the dense array of item sizes. Items are tracked in index
+/// order, so ties are initially broken as by the linked strategy without a
+/// custom item order.
+void dancing_links::set_selection_strategy(selection_strategy strategy) {
+  assert(current_subset.empty());
+  dense.reset();
+  if (strategy == selection_strategy::dense)
+    dense.emplace(n_items);
+  for (std::size_t index = 0; index < n_items; ++index)
+    items[index].track(dense ? &*dense : nullptr,
+                       static_cast<std::uint32_t>(index));
+}
+
+/// Sets the number of options below which the search switches to bitsets.
+void dancing_links::set_bitset_threshold(std::size_t options) {
+  bitset_threshold = options;
+  bit_of.assign(n_items, 0);
+  compacted_at.assign(this->options.size(), 0);
+}
+
+/// Numbers the remaining items in list order, then collects the options
+/// still linked into their columns. These cover remaining items only, as
+/// options conflicting with the selection have been hidden. Since no option
+/// is longer than <longest>, the column sizes bound the number of options
+/// from below, which rules out most large residual problems before any
+/// option is visited.
+auto dancing_links::compact() -> bool {
+  auto n_remaining = std::size_t{0};
+  auto n_nodes = std::size_t{0};
+  for (auto &item : items) {
+    if (n_remaining == bitset_cover::max_items)
+      return false;
+    bit_of[index_of(item)] = static_cast<std::uint8_t>(n_remaining++);
+    n_nodes += item.count();
+  }
+  if (n_nodes > bitset_threshold * longest)
+    return false;
+
+  residual.reset(n_remaining);
+  auto n_options = std::size_t{0};
+  ++compactions;
+  for (auto &item : items) {
+    for (auto &node : item.covering_options()) {
+      auto &option = node.parent_option();
+      if (compacted_at[option.get_index()] == compactions)
+        continue;
+      if (++n_options > bitset_threshold)
+        return false;
+      compacted_at[option.get_index()] = compactions;
+
+      auto mask = std::uint64_t{0};
+      for (auto &other : option.nodes())
+        mask |= std::uint64_t{1} << bit_of[index_of(other.parent_item())];
+      residual.add_option(mask, option.get_index());
+    }
+  }
+  return true;
+}
+
+/// Relinks the list of uncovered items in the given order.
+void dancing_links::order_items(std::span<const std::size_t> order) {
+  assert(current_subset.empty());
+  items.reorder(order);
+}
+
+/// Counts search tree nodes below the current selection, up to <limit>.
+auto dancing_links::tree_size(std::size_t limit) -> std::size_t {
+  auto visited = std::size_t{0};
+  explore(visited, limit);
+  return visited;
+}
+
+/// Walks the search tree like <enumerate>, but only counts the nodes visited
+/// and stops as soon as the budget is spent.
+void dancing_links::explore(std::size_t &visited, std::size_t limit) {
+  if (++visited >= limit || this->exact_cover())
+    return;
+
+  auto &item = next_candidate();
+  for (auto &node : item.covering_options()) {
+    auto &option = node.parent_option();
     option.cover();
-    auto result = quicksolve();
-    if (!result.empty())
-      return result;
+    explore(visited, limit);
     option.uncover();
-    current_subset.pop_back();
+    if (visited >= limit)
+      return;
   }
-  return {};
+}
+
+/// Enables lookahead at the flagged depths.
+void dancing_links::set_lookahead(std::vector<bool> depths) {
+  lookahead_depths = std::move(depths);
+}
+
+/// Returns true if lookahead is enabled at the current depth.
+auto dancing_links::looks_ahead() const -> bool {
+  return current_subset.size() < lookahead_depths.size() &&
+         lookahead_depths[current_subset.size()];
+}
+
+/// Covers an option tentatively, then keeps covering the single option left
+/// for any item until either some item has no options left, or every item
+/// has at least two. All covering is undone before returning.
+auto dancing_links::consistent(option &option) -> bool {
+  option.cover();
+  auto satisfiable = true;
+  while (satisfiable && !this->exact_cover()) {
+    auto &item = next_candidate();
+    if (item.count() > 1)
+      break;
+    if (item.count() == 0) {
+      satisfiable = false;
+      break;
+    }
+    auto &only = (*item.covering_options().begin()).parent_option();
+    only.cover();
+    forced.push_back(&only);
+  }
+
+  for (; !forced.empty(); forced.pop_back())
+    forced.back()->uncover();
+  option.uncover();
+
+  if (!satisfiable)
+    ++pruned;
+  return satisfiable;
+}
+
+/// Attaches a store of nogoods, building the static item lists and selection
+/// bookkeeping that conflict analysis needs.
+void dancing_links::set_nogood_store(nogood_store *store) {
+  nogoods = store;
+  columns.clear();
+  covered_by.clear();
+  selected.clear();
+  if (store == nullptr)
+    return;
+
+  columns.resize(n_items);
+  covered_by.assign(n_items, none);
+  selected.assign(options.size(), false);
+  for (auto &option : options)
+    for (auto &node : option.nodes())
+      columns[index_of(node.parent_item())].push_back(option.get_index());
+  for (auto index : current_subset) {
+    selected[index] = true;
+    for (auto &node : options[index].nodes())
+      covered_by[index_of(node.parent_item())] = index;
+  }
+}
+
+/// Recursive search deriving conflict sets. The conflict set of a subtree
+/// without solutions collects, for each option of the item branched on, why
+/// it cannot be part of a solution: the selected option it conflicts with,
+/// the rest of the nogood it would complete, or the conflict set of its own
+/// subtree. Subtrees cut short by the budget count as solved, so that no
+/// nogood is learned from them.
+auto dancing_links::learn(const visitor &visit,
+                          std::vector<std::size_t> &conflict) -> bool {
+  conflict.clear();
+  if (this->exact_cover()) {
+    visit(current_subset);
+    return true;
+  }
+  if (out_of_budget())
+    return true;
+
+  auto &item = next_candidate();
+  for (auto index : columns[index_of(item)])
+    if (auto reason = blocker(index); reason != none)
+      conflict.push_back(reason);
+
+  auto found = false;
+  auto reasons = std::vector<std::size_t>{};
+  for (auto &node : item.covering_options()) {
+    auto &option = node.parent_option();
+    const auto index = option.get_index();
+    if (auto *nogood = nogoods->find(index, selected)) {
+      for (auto other : *nogood)
+        if (other != index)
+          conflict.push_back(other);
+      continue;
+    }
+
+    choose(option);
+    auto solved = learn(visit, reasons);
+    unchoose(option);
+    if (halted)
+      return true;
+    if (solved) {
+      found = true;
+      continue;
+    }
+
+    if (!found &&
+        std::find(reasons.begin(), reasons.end(), index) == reasons.end()) {
+      conflict.swap(reasons); // Failure does not depend on this branch.
+      return false;
+    }
+    for (auto other : reasons)
+      if (other != index)
+        conflict.push_back(other);
+  }
+
+  if (found)
+    return true;
+  std::sort(conflict.begin(), conflict.end());
+  conflict.erase(std::unique(conflict.begin(), conflict.end()),
+                 conflict.end());
+  nogoods->learn(conflict);
+  return false;
+}
+
+/// Selects an option, keeping track of which items it covers while learning.
+void dancing_links::choose(option &option) {
+  current_subset.push_back(option.get_index());
+  option.cover();
+  if (nogoods == nullptr)
+    return;
+  selected[option.get_index()] = true;
+  for (auto &node : option.nodes())
+    covered_by[index_of(node.parent_item())] = option.get_index();
+}
+
+/// Deselects the most recently selected option.
+void dancing_links::unchoose(option &option) {
+  if (nogoods != nullptr) {
+    selected[option.get_index()] = false;
+    for (auto &node : option.nodes())
+      covered_by[index_of(node.parent_item())] = none;
+  }
+  option.uncover();
+  current_subset.pop_back();
+}
+
+/// An option conflicts with a selected option if they share an item.
+auto dancing_links::blocker(std::size_t index) -> std::size_t {
+  for (auto &node : options[index].nodes())
+    if (auto reason = covered_by[index_of(node.parent_item())]; reason != none)
+      return reason;
+  return none;
+}
+
+/// Items are stored contiguously, so their index follows from their address.
+auto dancing_links::index_of(item &item) -> std::size_t {
+  return static_cast<std::size_t>(&item - &items[0]);
 }
 
 /// Returns true if the current subset of options covers all items.
@@ -241,6 +899,8 @@ auto dancing_links::exact_cover() const -> bool { return items.empty(); }
 /// Current heuristic for determining this candidate is the one with
 /// the smallest size.
 auto dancing_links::next_candidate() -> item & {
+  if (dense)
+    return items[dense->minimum()];
   return *std::min_element(items.begin(), items.end(),
                            [](const auto &left, const auto &right) {
                              return left.count() < right.count();
@@ -0,0 +1,541 @@
+//===-- distributed_search.cpp - Distributed search -------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implementation of the search distributed over worker processes.
+///
+//===----------------------------------------------------------------------===//
+
+#include "distributed_search.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <set>
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "dancing_links.h"
+#include "instance_io.h"
+#include "socket_io.h"
+#include "wire.h"
+
+using namespace dlx;
+
+namespace {
+/// Messages exchanged between coordinator and workers, each sent as its
+/// type and payload size as 32-bit integers, followed by the payload.
+enum class message : std::uint32_t {
+  problem,  ///< Whether to report solutions, then the problem.
+  work,     ///< A prefix and the extensions of it to skip.
+  donate,   ///< Request to give away unexplored options.
+  quit,     ///< Request to shut down.
+  solution, ///< An exact cover found.
+  donation, ///< Prefixes given away.
+  nothing,  ///< No unexplored options to give away.
+  done,     ///< Number of exact covers below the prefix.
+};
+
+using prefix = std::vector<std::size_t>;
+
+/// A prefix to search below, skipping the subtrees below <excluded>.
+struct work_item {
+  prefix selection = {};
+  std::vector<prefix> excluded = {};
+};
+
+/// Search steps between checks for requests from the coordinator.
+constexpr std::size_t check_interval = 64;
+
+/// Time before asking a worker that had nothing to give to donate again.
+constexpr auto retry_delay = std::chrono::milliseconds{2};
+
+auto send(int fd, message type, std::span<const std::uint8_t> payload = {})
+    -> bool {
+  auto frame = std::vector<std::uint8_t>{};
+  frame.reserve(8 + payload.size());
+  wire::put<4>(frame, static_cast<std::uint32_t>(type));
+  wire::put<4>(frame, payload.size());
+  frame.insert(frame.end(), payload.begin(), payload.end());
+  return io::write_all(fd, frame);
+}
+
+auto receive(int fd, message &type, std::vector<std::uint8_t> &payload)
+    -> bool {
+  auto header = std::array<std::uint8_t, 8>{};
+  if (!io::read_exact(fd, header.data(), header.size()))
+    return false;
+  auto offset = std::size_t{0};
+  type = static_cast<message>(*wire::get<4>(header, offset));
+  payload.resize(*wire::get<4>(header, offset));
+  return io::read_exact(fd, payload.data(), payload.size());
+}
+
+/// Lists of option indices are sent as their length and elements.
+/// @{
+void put_list(std::vector<std::uint8_t> &buffer,
+              std::span<const std::size_t> list) {
+  wire::put<4>(buffer, list.size());
+  for (auto element : list)
+    wire::put<4>(buffer, element);
+}
+
+auto get_list(std::span<const std::uint8_t> data, std::size_t &offset,
+              prefix &list) -> bool {
+  auto size = wire::get<4>(data, offset);
+  if (!size || *size > (data.size() - offset) / 4)
+    return false;
+  list.resize(*size);
+  for (auto &element : list)
+    element = *wire::get<4>(data, offset);
+  return true;
+}
+
+void put_lists(std::vector<std::uint8_t> &buffer,
+               const std::vector<prefix> &lists) {
+  wire::put<4>(buffer, lists.size());
+  for (const auto &list : lists)
+    put_list(buffer, list);
+}
+
+auto get_lists(std::span<const std::uint8_t> data, std::size_t &offset,
+               std::vector<prefix> &lists) -> bool {
+  auto size = wire::get<4>(data, offset);
+  if (!size || *size > (data.size() - offset) / 4)
+    return false;
+  lists.resize(*size);
+  for (auto &list : lists)
+    if (!get_list(data, offset, list))
+      return false;
+  return true;
+}
+/// @}
+
+//===-- worker search -----------------------------------------------------===//
+/// A level of a worker's search: the options to try and the next one.
+struct frame {
+  std::vector<std::size_t> options;
+  std::size_t next = 0;
+};
+
+/// Depth-first search below a prefix on an explicit stack, so that the
+/// untried options at the shallowest level can be given away on request.
+class worker_search {
+public:
+  worker_search(dancing_links &matrix, int input, int output, bool keep)
+      : matrix{matrix}, input{input}, output{output}, keep{keep} {}
+
+  /// Searches below a prefix, reporting solutions as they are found.
+  /// Returns false if the connection was lost.
+  auto run(const work_item &work, std::size_t &count) -> bool {
+    excluded = std::set<prefix>(work.excluded.begin(), work.excluded.end());
+    depth = work.selection.size();
+    for (auto option : work.selection)
+      matrix.select(option);
+
+    auto connected = true;
+    if (matrix.exact_cover())
+      connected = report(count);
+    else
+      stack.push_back({matrix.candidates()});
+
+    for (std::size_t steps = 1; connected && !stack.empty(); ++steps) {
+      if (steps % check_interval == 0 && !answer_requests()) {
+        connected = false;
+        break;
+      }
+      auto &top = stack.back();
+      if (top.next == top.options.size()) {
+        stack.pop_back();
+        if (!stack.empty())
+          matrix.deselect();
+        continue;
+      }
+      auto option = top.options[top.next++];
+      if (skipped(option))
+        continue;
+      matrix.select(option);
+      if (matrix.exact_cover()) {
+        connected = report(count);
+        matrix.deselect();
+      } else {
+        stack.push_back({matrix.candidates()});
+      }
+    }
+
+    for (; stack.size() > 1; stack.pop_back())
+      matrix.deselect();
+    stack.clear();
+    for (std::size_t i = 0; i < depth; ++i)
+      matrix.deselect();
+    return connected;
+  }
+
+private:
+  auto report(std::size_t &count) -> bool {
+    ++count;
+    if (!keep)
+      return true;
+    auto payload = std::vector<std::uint8_t>{};
+    put_list(payload, matrix.selection());
+    return send(output, message::solution, payload);
+  }
+
+  /// Returns true if selecting <option> leads into an excluded subtree.
+  auto skipped(std::size_t option) const -> bool {
+    if (excluded.empty())
+      return false;
+    auto selection = matrix.selection();
+    auto path = prefix(selection.begin(), selection.end());
+    path.push_back(option);
+    return excluded.contains(path);
+  }
+
+  /// Handles a pending request from the coordinator, if any.
+  auto answer_requests() -> bool {
+    auto pending = pollfd{input, POLLIN, 0};
+    if (::poll(&pending, 1, 0) <= 0)
+      return true;
+    auto type = message{};
+    auto payload = std::vector<std::uint8_t>{};
+    if (!receive(input, type, payload) || type != message::donate)
+      return false;
+    return donate();
+  }
+
+  /// Gives away the untried options of the shallowest level that has any.
+  auto donate() -> bool {
+    auto level = std::find_if(stack.begin(), stack.end(), [](auto &frame) {
+      return frame.next < frame.options.size();
+    });
+    if (level == stack.end())
+      return send(output, message::nothing);
+
+    auto selection = matrix.selection();
+    auto base = prefix(selection.begin(),
+                       selection.begin() + depth + (level - stack.begin()));
+    auto donated = std::vector<prefix>{};
+    for (; level->next < level->options.size(); ++level->next) {
+      auto path = base;
+      path.push_back(level->options[level->next]);
+      if (!excluded.contains(path))
+        donated.push_back(std::move(path));
+    }
+    if (donated.empty())
+      return send(output, message::nothing);
+    auto payload = std::vector<std::uint8_t>{};
+    put_lists(payload, donated);
+    return send(output, message::donation, payload);
+  }
+
+  dancing_links &matrix;
+  int input, output;
+  bool keep;
+  std::size_t depth = 0;
+  std::vector<frame> stack = {};
+  std::set<prefix> excluded = {};
+};
+
+//===-- worker processes --------------------------------------------------===//
+using clock = std::chrono::steady_clock;
+
+/// A worker process as seen by the coordinator. Solutions and donations
+/// are tracked per prefix, so that the prefix can be reissued if the worker
+/// crashes.
+struct worker_process {
+  pid_t pid = -1;
+  io::descriptor connection{};
+  std::optional<work_item> assigned = {};
+  std::vector<prefix> donated = {};
+  std::vector<prefix> found = {};
+  bool asked = false;
+  clock::time_point refused = {};
+};
+} // namespace
+
+//===-- worker ------------------------------------------------------------===//
+/// Receives the problem once, then searches the prefixes it is sent.
+auto dlx::run_worker(int input, int output) -> bool {
+  auto type = message{};
+  auto payload = std::vector<std::uint8_t>{};
+  if (!receive(input, type, payload) || type != message::problem ||
+      payload.size() < 4)
+    return false;
+  auto keep = payload[0] != 0;
+  auto problem = decode_instance(std::span{payload}.subspan(4));
+  if (!problem)
+    return false;
+
+  auto matrix = dancing_links{*problem};
+  auto search = worker_search{matrix, input, output, keep};
+  while (receive(input, type, payload)) {
+    switch (type) {
+    case message::work: {
+      auto work = work_item{};
+      auto offset = std::size_t{0};
+      if (!get_list(payload, offset, work.selection) ||
+          !get_lists(payload, offset, work.excluded))
+        return false;
+      auto count = std::size_t{0};
+      if (!search.run(work, count))
+        return false;
+      auto result = std::vector<std::uint8_t>{};
+      wire::put<8>(result, count);
+      if (!send(output, message::done, result))
+        return false;
+      break;
+    }
+    case message::donate:
+      if (!send(output, message::nothing))
+        return false;
+      break;
+    case message::quit:
+      return true;
+    default:
+      return false;
+    }
+  }
+  return false;
+}
+
+//===-- coordinator -------------------------------------------------------===//
+coordinator::coordinator(instance problem, distribution_settings settings)
+    : problem{std::move(problem)}, settings{std::move(settings)},
+      entry{[](int connection, std::size_t) {
+        run_worker(connection, connection);
+      }} {
+  this->settings.workers = std::max(this->settings.workers, std::size_t{1});
+}
+
+void coordinator::set_worker_entry(
+    std::function<void(int, std::size_t)> entry) {
+  this->entry = std::move(entry);
+}
+
+auto coordinator::count() -> std::optional<std::size_t> {
+  auto total = std::size_t{0};
+  auto solutions = std::vector<std::vector<std::size_t>>{};
+  if (!run(false, total, solutions))
+    return std::nullopt;
+  return total;
+}
+
+auto coordinator::solve()
+    -> std::optional<std::vector<std::vector<std::size_t>>> {
+  auto total = std::size_t{0};
+  auto solutions = std::vector<std::vector<std::size_t>>{};
+  if (!run(true, total, solutions))
+    return std::nullopt;
+  return solutions;
+}
+
+/// Event loop of the coordinator: hands out queued prefixes to idle workers,
+/// asks busy workers for donations while any worker is idle, and collects
+/// results as workers finish their prefixes.
+auto coordinator::run(bool keep_solutions, std::size_t &total,
+                      std::vector<std::vector<std::size_t>> &solutions)
+    -> bool {
+  auto header = std::vector<std::uint8_t>{keep_solutions, 0, 0, 0};
+  auto encoded = encode_instance(problem);
+  header.insert(header.end(), encoded.begin(), encoded.end());
+
+  auto workers = std::vector<worker_process>(settings.workers);
+  auto started = std::size_t{0};
+  auto start = [&](worker_process &worker) {
+    worker = worker_process{};
+    int ends[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, ends) != 0)
+      return;
+    auto pid = ::fork();
+    if (pid == 0) {
+      ::close(ends[0]);
+      for (auto &other : workers)
+        if (other.connection)
+          ::close(other.connection.get());
+      if (!settings.executable.empty()) {
+        ::dup2(ends[1], 0);
+        ::dup2(ends[1], 1);
+        ::execl(settings.executable.c_str(), settings.executable.c_str(),
+                "--worker", nullptr);
+      } else {
+        entry(ends[1], started);
+      }
+      ::_exit(0);
+    }
+    ::close(ends[1]);
+    ++started;
+    if (pid < 0) {
+      ::close(ends[0]);
+      return;
+    }
+    worker.pid = pid;
+    worker.connection = io::descriptor{ends[0]};
+  };
+
+  auto queue = std::deque<work_item>{work_item{}};
+  auto restarts = settings.restarts;
+  auto crashed = [&](worker_process &worker) {
+    ::kill(worker.pid, SIGKILL);
+    ::waitpid(worker.pid, nullptr, 0);
+    if (worker.assigned) {
+      auto &work = *worker.assigned;
+      work.excluded.insert(work.excluded.end(), worker.donated.begin(),
+                           worker.donated.end());
+      queue.push_front(std::move(work));
+    }
+    worker = worker_process{};
+    for (; !worker.connection && restarts > 0; --restarts) {
+      start(worker);
+      if (worker.connection &&
+          !send(worker.connection.get(), message::problem, header)) {
+        ::kill(worker.pid, SIGKILL);
+        ::waitpid(worker.pid, nullptr, 0);
+        worker = worker_process{};
+      }
+    }
+  };
+
+  for (auto &worker : workers) {
+    start(worker);
+    if (worker.connection &&
+        !send(worker.connection.get(), message::problem, header))
+      crashed(worker);
+  }
+
+  auto type = message{};
+  auto payload = std::vector<std::uint8_t>{};
+  auto descriptors = std::vector<pollfd>{};
+  while (true) {
+    auto idle = std::size_t{0};
+    for (auto &worker : workers) {
+      if (!worker.connection || worker.assigned)
+        continue;
+      if (queue.empty()) {
+        ++idle;
+        continue;
+      }
+      auto work = std::vector<std::uint8_t>{};
+      put_list(work, queue.front().selection);
+      put_lists(work, queue.front().excluded);
+      worker.assigned = std::move(queue.front());
+      queue.pop_front();
+      if (!send(worker.connection.get(), message::work, work))
+        crashed(worker);
+    }
+
+    auto busy = std::any_of(workers.begin(), workers.end(),
+                            [](auto &worker) { return !!worker.assigned; });
+    if (!busy) {
+      if (queue.empty())
+        break;
+      if (std::none_of(workers.begin(), workers.end(),
+                       [](auto &worker) { return !!worker.connection; }))
+        return false;
+      continue;
+    }
+
+    auto now = clock::now();
+    for (auto &worker : workers) {
+      if (idle == 0)
+        break;
+      if (!worker.assigned || worker.asked ||
+          now - worker.refused < retry_delay)
+        continue;
+      worker.asked = true;
+      if (!send(worker.connection.get(), message::donate))
+        crashed(worker);
+    }
+
+    descriptors.clear();
+    for (auto &worker : workers)
+      descriptors.push_back({worker.connection.get(), POLLIN, 0});
+    if (::poll(descriptors.data(), descriptors.size(),
+               static_cast<int>(retry_delay.count())) < 0)
+      continue;
+
+    for (std::size_t i = 0; i < workers.size(); ++i) {
+      auto &worker = workers[i];
+      if (descriptors[i].revents == 0 || !worker.connection)
+        continue;
+      if (!receive(worker.connection.get(), type, payload)) {
+        crashed(worker);
+        continue;
+      }
+
+      auto offset = std::size_t{0};
+      switch (type) {
+      case message::solution: {
+        auto &found = worker.found.emplace_back();
+        if (!get_list(payload, offset, found))
+          crashed(worker);
+        break;
+      }
+      case message::donation: {
+        auto donated = std::vector<prefix>{};
+        if (!get_lists(payload, offset, donated)) {
+          crashed(worker);
+          break;
+        }
+        worker.asked = false;
+        for (auto &selection : donated) {
+          worker.donated.push_back(selection);
+          queue.push_back({std::move(selection), {}});
+        }
+        break;
+      }
+      case message::nothing:
+        worker.asked = false;
+        worker.refused = clock::now();
+        break;
+      case message::done: {
+        auto count = wire::get<8>(payload, offset);
+        if (!count) {
+          crashed(worker);
+          break;
+        }
+        total += *count;
+        for (auto &solution : worker.found)
+          solutions.push_back(std::move(solution));
+        worker.found.clear();
+        worker.donated.clear();
+        worker.assigned.reset();
+        break;
+      }
+      default:
+        crashed(worker);
+      }
+    }
+  }
+
+  for (auto &worker : workers) {
+    if (!worker.connection)
+      continue;
+    send(worker.connection.get(), message::quit);
+    worker.connection = io::descriptor{};
+    ::waitpid(worker.pid, nullptr, 0);
+  }
+  return true;
+}
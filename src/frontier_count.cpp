@@ -0,0 +1,170 @@
+//===-- frontier_count.cpp - Frontier counting ------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implements the sweep counting exact covers of tiling problems.
+///
+//===----------------------------------------------------------------------===//
+
+#include "frontier_count.h"
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <span>
+#include <unordered_map>
+#include <utility>
+
+using namespace dlx;
+
+namespace {
+/// A partial cover, short of the first uncovered cell: the items off the
+/// board covered, followed by the cells after the first uncovered one that
+/// are covered.
+using frontier = std::vector<std::size_t>;
+
+struct frontier_hash {
+  auto operator()(const frontier &state) const noexcept -> std::size_t {
+    auto hash = std::size_t{14695981039346656037ull};
+    for (auto value : state)
+      hash = (hash ^ value) * 1099511628211ull;
+    return hash;
+  }
+};
+
+/// Number of partial covers reaching each frontier.
+using frontier_counts =
+    std::unordered_map<frontier, std::size_t, frontier_hash>;
+
+/// Number of rows and of columns spanned by the cells <on_board>.
+auto extent(const instance &problem, const std::vector<std::size_t> &on_board)
+    -> std::pair<std::size_t, std::size_t> {
+  auto first = *problem.cells[on_board.front()], last = first;
+  for (auto item : on_board) {
+    auto position = *problem.cells[item];
+    first.row = std::min(first.row, position.row);
+    first.column = std::min(first.column, position.column);
+    last.row = std::max(last.row, position.row);
+    last.column = std::max(last.column, position.column);
+  }
+  return {last.row - first.row + 1, last.column - first.column + 1};
+}
+} // namespace
+
+auto dlx::plan_sweep(const instance &problem)
+    -> std::optional<board_sweep> {
+  if (problem.cells.size() != problem.items)
+    return {};
+
+  auto on_board = std::vector<std::size_t>{};
+  for (std::size_t item = 0; item < problem.items; ++item)
+    if (problem.cells[item])
+      on_board.push_back(item);
+  auto n_others = problem.items - on_board.size();
+  if (on_board.empty() || n_others > board_sweep::max_others)
+    return {};
+  // The board is swept along its longer side, so that the frontier spans
+  // the shorter one.
+  auto [rows, columns] = extent(problem, on_board);
+  auto by_rows = rows > columns;
+  auto key = [&](std::size_t item) {
+    auto &position = *problem.cells[item];
+    return by_rows ? std::pair{position.row, position.column}
+                   : std::pair{position.column, position.row};
+  };
+  std::stable_sort(on_board.begin(), on_board.end(),
+                   [&](auto a, auto b) { return key(a) < key(b); });
+
+  // Cells are numbered in sweep order, the other items in index order.
+  constexpr auto off_board = static_cast<std::size_t>(-1);
+  auto position = std::vector<std::size_t>(problem.items, off_board);
+  for (std::size_t i = 0; i < on_board.size(); ++i)
+    position[on_board[i]] = i;
+  auto bit = std::vector<std::size_t>(problem.items);
+  auto sweep = board_sweep{};
+  sweep.n_cells = on_board.size();
+  sweep.starting_at.resize(sweep.n_cells);
+  for (std::size_t item = 0, next_bit = 0; item < problem.items; ++item) {
+    if (position[item] != off_board)
+      continue;
+    bit[item] = next_bit++;
+    sweep.all_others |= std::uint64_t{1} << bit[item];
+  }
+
+  for (const auto &option : problem.options) {
+    auto placed = board_sweep::placement{};
+    for (auto item : option) {
+      if (position[item] == off_board)
+        placed.others |= std::uint64_t{1} << bit[item];
+      else
+        placed.cells.push_back(position[item]);
+    }
+    if (placed.cells.empty())
+      return {};
+    std::sort(placed.cells.begin(), placed.cells.end());
+    sweep.reach =
+        std::max(sweep.reach, placed.cells.back() - placed.cells.front());
+    sweep.starting_at[placed.cells.front()].push_back(std::move(placed));
+  }
+  return sweep;
+}
+
+auto dlx::count_by_sweep(const board_sweep &sweep,
+                         const std::function<bool()> &stop) -> std::size_t {
+  // Partial covers by their first uncovered cell, which only moves forward.
+  auto pending = std::map<std::size_t, frontier_counts>{};
+  pending[0][frontier{0}] = 1;
+  while (!pending.empty()) {
+    auto first = pending.extract(pending.begin());
+    auto cell = first.key();
+    if (cell == sweep.n_cells)
+      return first.mapped()[frontier{sweep.all_others}];
+
+    for (const auto &[state, ways] : first.mapped()) {
+      if (stop && stop())
+        return 0;
+      auto covered = std::span{state}.subspan(1);
+      for (const auto &placed : sweep.starting_at[cell]) {
+        if ((placed.others & state.front()) != 0)
+          continue;
+        auto rest = std::span{placed.cells}.subspan(1);
+        auto conflicts = std::any_of(rest.begin(), rest.end(), [&](auto c) {
+          return std::binary_search(covered.begin(), covered.end(), c);
+        });
+        if (conflicts)
+          continue;
+
+        auto next = frontier{state.front() | placed.others};
+        std::merge(covered.begin(), covered.end(), rest.begin(), rest.end(),
+                   std::back_inserter(next));
+        auto uncovered = cell + 1;
+        auto skipped = std::size_t{1};
+        while (skipped < next.size() && next[skipped] == uncovered) {
+          ++skipped;
+          ++uncovered;
+        }
+        next.erase(next.begin() + 1, next.begin() + skipped);
+        pending[uncovered][std::move(next)] += ways;
+      }
+    }
+  }
+  return 0;
+}
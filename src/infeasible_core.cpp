@@ -0,0 +1,123 @@
+//===-- infeasible_core.cpp - Infeasible cores ------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implementation of the extraction of small sets of items that already admit
+/// no exact cover.
+///
+//===----------------------------------------------------------------------===//
+
+#include "infeasible_core.h"
+
+#include <algorithm>
+
+#include "dancing_links.h"
+
+using namespace dlx;
+
+auto dlx::restrict_items(const instance &problem,
+                         std::span<const std::size_t> items) -> instance {
+  constexpr auto absent = static_cast<std::size_t>(-1);
+  auto position = std::vector<std::size_t>(problem.items, absent);
+  for (std::size_t i = 0; i < items.size(); ++i)
+    position[items[i]] = i;
+
+  auto restricted = instance{items.size(), {}};
+  auto option = std::vector<std::size_t>{};
+  for (const auto &original : problem.options) {
+    option.clear();
+    for (auto item : original)
+      if (position[item] != absent)
+        option.push_back(position[item]);
+    if (!option.empty())
+      restricted.options.push_back(option);
+  }
+  if (!problem.cells.empty())
+    for (auto item : items)
+      restricted.cells.push_back(problem.cells[item]);
+  return restricted;
+}
+
+namespace {
+/// Checks restrictions of a problem for exact covers, remembering the items
+/// covered by each restriction found to have one.
+class feasibility_oracle {
+public:
+  explicit feasibility_oracle(const instance &problem) : problem{problem} {}
+
+  /// Returns true if the restriction to <items> has an exact cover.
+  auto feasible(std::span<const std::size_t> items) -> bool {
+    for (const auto &covered : witnesses) {
+      if (std::all_of(items.begin(), items.end(),
+                      [&](auto item) { return covered[item]; }))
+        return true;
+    }
+
+    ++searches;
+    auto restricted = restrict_items(problem, items);
+    auto matrix = dancing_links{restricted};
+    if (matrix.quicksolve().empty() && !items.empty())
+      return false;
+
+    auto &covered = witnesses.emplace_back(problem.items, false);
+    for (auto item : items)
+      covered[item] = true;
+    return true;
+  }
+
+  std::size_t searches = 0;
+
+private:
+  const instance &problem;
+  std::vector<std::vector<bool>> witnesses = {};
+};
+} // namespace
+
+/// Tries to remove each chunk of the remaining items in turn, halving the
+/// chunk size after every pass. The final pass removes single items, each
+/// of which is then needed: if removing an item left a feasible set, it
+/// still does after removing further items.
+auto dlx::find_infeasible_core(const instance &problem)
+    -> std::optional<infeasible_core> {
+  auto oracle = feasibility_oracle{problem};
+  auto core = std::vector<std::size_t>(problem.items);
+  for (std::size_t item = 0; item < core.size(); ++item)
+    core[item] = item;
+  if (oracle.feasible(core))
+    return std::nullopt;
+
+  auto remaining = std::vector<std::size_t>{};
+  for (auto chunk = std::max(core.size() / 2, std::size_t{1});;
+       chunk = std::max(chunk / 2, std::size_t{1})) {
+    for (std::size_t begin = 0; begin < core.size();) {
+      auto end = std::min(begin + chunk, core.size());
+      remaining.assign(core.begin(), core.begin() + begin);
+      remaining.insert(remaining.end(), core.begin() + end, core.end());
+      if (!oracle.feasible(remaining))
+        core = remaining;
+      else
+        begin = end;
+    }
+    if (chunk == 1)
+      break;
+  }
+  return infeasible_core{std::move(core), oracle.searches};
+}
@@ -0,0 +1,276 @@
+//===-- instance_io.cpp - Instance text format ------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implementation of the line-based text format for exact cover problems.
+///
+//===----------------------------------------------------------------------===//
+
+#include "instance_io.h"
+
+#include <algorithm>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "wire.h"
+
+using namespace dlx;
+
+namespace {
+/// Splits a line into whitespace-separated names.
+auto split(std::string_view line) -> std::vector<std::string_view> {
+  constexpr auto whitespace = std::string_view{" \t\r\v\f"};
+  auto names = std::vector<std::string_view>{};
+  auto begin = line.find_first_not_of(whitespace);
+  while (begin != std::string_view::npos) {
+    auto end = line.find_first_of(whitespace, begin);
+    if (end == std::string_view::npos)
+      end = line.size();
+    names.push_back(line.substr(begin, end - begin));
+    begin = line.find_first_not_of(whitespace, end);
+  }
+  return names;
+}
+
+/// Removes and returns the first line of <text>.
+auto next_line(std::string_view &text) -> std::string_view {
+  auto end = text.find('\n');
+  auto line = text.substr(0, end);
+  text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+  return line;
+}
+
+/// Names reserved for secondary items and colors are rejected.
+auto valid_name(std::string_view name) -> bool {
+  return name.find_first_of("|:") == std::string_view::npos;
+}
+
+using name_table = std::unordered_map<std::string_view, std::size_t>;
+
+/// Text below this size is not split over multiple threads.
+constexpr std::size_t min_chunk_size = std::size_t{1} << 16;
+
+/// Options parsed by one thread: the items of all options one after the
+/// other, and the position in <items> where each option ends.
+struct parsed_chunk {
+  std::vector<std::size_t> items = {};
+  std::vector<std::size_t> ends = {};
+  bool valid = true;
+};
+
+/// Parses the options in <text>, returning false if an option names an
+/// unknown item or lists an item twice.
+auto parse_options(std::string_view text, const name_table &index,
+                   parsed_chunk &chunk) -> bool {
+  auto seen_in = std::vector<std::size_t>(index.size(), std::size_t(-1));
+  while (!text.empty()) {
+    auto names = split(next_line(text));
+    if (names.empty() || names.front().front() == '|')
+      continue;
+
+    auto current = chunk.ends.size();
+    for (auto name : names) {
+      auto item = index.find(name);
+      if (item == index.end() || seen_in[item->second] == current)
+        return false;
+      seen_in[item->second] = current;
+      chunk.items.push_back(item->second);
+    }
+    chunk.ends.push_back(chunk.items.size());
+  }
+  return true;
+}
+
+/// Runs <task> for each thread index, on the calling thread if only one.
+template <typename Task> void in_parallel(std::size_t n_threads, Task task) {
+  if (n_threads == 1)
+    return task(0);
+  auto workers = std::vector<std::thread>{};
+  workers.reserve(n_threads);
+  for (std::size_t thread = 0; thread < n_threads; ++thread)
+    workers.emplace_back(task, thread);
+  for (auto &worker : workers)
+    worker.join();
+}
+} // namespace
+
+/// The serial parser is the parallel one run on the calling thread.
+auto dlx::parse_instance(std::string_view text) -> std::optional<instance> {
+  return parse_instance(text, 1);
+}
+
+/// The first line holding any names declares the items; the name table is
+/// built from it before the options are parsed, and is only read afterwards,
+/// so that threads can share it without locking. The options are split into
+/// chunks at line boundaries, and each thread parses its chunk into a flat
+/// buffer. A prefix sum over the number of options per chunk then gives each
+/// thread the position of its options in the problem, which it fills in.
+auto dlx::parse_instance(std::string_view text, std::size_t n_threads)
+    -> std::optional<instance> {
+  auto index = name_table{};
+  auto header = std::vector<std::string_view>{};
+  while (!text.empty() && header.empty()) {
+    header = split(next_line(text));
+    if (!header.empty() && header.front().front() == '|')
+      header.clear();
+  }
+  if (header.empty())
+    return std::nullopt;
+  for (auto name : header) {
+    if (!valid_name(name) || !index.emplace(name, index.size()).second)
+      return std::nullopt;
+  }
+
+  auto max_threads = std::max(text.size() / min_chunk_size, std::size_t{1});
+  n_threads = std::clamp(n_threads, std::size_t{1}, max_threads);
+  auto boundaries = std::vector<std::size_t>{0};
+  for (std::size_t thread = 1; thread < n_threads; ++thread) {
+    auto boundary = std::max(text.size() * thread / n_threads,
+                             boundaries.back());
+    boundary = text.find('\n', boundary);
+    boundaries.push_back(boundary == std::string_view::npos ? text.size()
+                                                            : boundary + 1);
+  }
+  boundaries.push_back(text.size());
+
+  auto chunks = std::vector<parsed_chunk>(n_threads);
+  in_parallel(n_threads, [&](std::size_t thread) {
+    auto chunk = text.substr(boundaries[thread],
+                             boundaries[thread + 1] - boundaries[thread]);
+    chunks[thread].valid = parse_options(chunk, index, chunks[thread]);
+  });
+  if (std::any_of(chunks.begin(), chunks.end(),
+                  [](auto &chunk) { return !chunk.valid; }))
+    return std::nullopt;
+
+  auto offsets = std::vector<std::size_t>{0};
+  for (const auto &chunk : chunks)
+    offsets.push_back(offsets.back() + chunk.ends.size());
+
+  auto problem = instance{header.size(), {}};
+  problem.options.resize(offsets.back());
+  in_parallel(n_threads, [&](std::size_t thread) {
+    auto &chunk = chunks[thread];
+    auto begin = std::size_t{0};
+    for (std::size_t i = 0; i < chunk.ends.size(); ++i) {
+      problem.options[offsets[thread] + i].assign(
+          chunk.items.begin() + begin, chunk.items.begin() + chunk.ends[i]);
+      begin = chunk.ends[i];
+    }
+  });
+  return problem;
+}
+
+/// Reads the remainder of the stream before parsing it.
+auto dlx::read_instance(std::istream &stream) -> std::optional<instance> {
+  auto text = std::string{std::istreambuf_iterator<char>{stream}, {}};
+  return parse_instance(text);
+}
+
+void dlx::write_instance(std::ostream &stream, const instance &problem) {
+  for (std::size_t item = 0; item < problem.items; ++item)
+    stream << (item ? " " : "") << item;
+  stream << '\n';
+  for (const auto &option : problem.options) {
+    for (std::size_t i = 0; i < option.size(); ++i)
+      stream << (i ? " " : "") << option[i];
+    stream << '\n';
+  }
+}
+
+auto dlx::encode_instance(const instance &problem)
+    -> std::vector<std::uint8_t> {
+  auto data = std::vector<std::uint8_t>{};
+  wire::put<4>(data, problem.items);
+  wire::put<4>(data, problem.options.size());
+  for (const auto &option : problem.options) {
+    wire::put<4>(data, option.size());
+    for (auto item : option)
+      wire::put<4>(data, item);
+  }
+  for (const auto &cell : problem.cells) {
+    wire::put<4>(data, cell.has_value());
+    if (cell) {
+      wire::put<4>(data, cell->row);
+      wire::put<4>(data, cell->column);
+    }
+  }
+  return data;
+}
+
+/// Sizes are checked against the remaining data before allocating, so that
+/// corrupt counts cannot cause huge allocations.
+auto dlx::decode_instance(std::span<const std::uint8_t> data)
+    -> std::optional<instance> {
+  auto offset = std::size_t{0};
+  auto items = wire::get<4>(data, offset);
+  auto n_options = wire::get<4>(data, offset);
+  if (!items || !n_options || *n_options > (data.size() - offset) / 4)
+    return std::nullopt;
+
+  auto problem = instance{*items, {}};
+  problem.options.resize(*n_options);
+  auto distinct = std::vector<std::size_t>{};
+  for (auto &option : problem.options) {
+    auto size = wire::get<4>(data, offset);
+    if (!size || *size > (data.size() - offset) / 4)
+      return std::nullopt;
+    option.reserve(*size);
+    for (std::size_t i = 0; i < *size; ++i) {
+      auto item = *wire::get<4>(data, offset);
+      if (item >= *items)
+        return std::nullopt;
+      option.push_back(item);
+    }
+    // Item counts are not bounded by the data, so duplicates are found by
+    // sorting rather than by marking items.
+    distinct.assign(option.begin(), option.end());
+    std::sort(distinct.begin(), distinct.end());
+    if (std::adjacent_find(distinct.begin(), distinct.end()) != distinct.end())
+      return std::nullopt;
+  }
+  if (offset == data.size())
+    return problem;
+
+  if (*items > (data.size() - offset) / 4)
+    return std::nullopt;
+  problem.cells.resize(*items);
+  for (auto &cell : problem.cells) {
+    auto on_board = wire::get<4>(data, offset);
+    if (!on_board || *on_board > 1)
+      return std::nullopt;
+    if (*on_board == 0)
+      continue;
+    auto row = wire::get<4>(data, offset);
+    auto column = wire::get<4>(data, offset);
+    if (!row || !column)
+      return std::nullopt;
+    cell = dlx::cell{*row, *column};
+  }
+  if (offset != data.size())
+    return std::nullopt;
+  return problem;
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+//===-- item_ordering.cpp - Item ordering -----------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implementation of profile-guided item ordering.
+///
+//===----------------------------------------------------------------------===//
+
+#include "item_ordering.h"
+
+#include <algorithm>
+#include <istream>
+#include <numeric>
+#include <ostream>
+#include <random>
+
+#include "dancing_links.h"
+
+using namespace dlx;
+
+/// Scores each item by the total size of the subtrees below its options,
+/// summed over all probes, and sorts the items by score. Ties keep their
+/// original order.
+auto dlx::probe_item_order(const instance &problem,
+                           const probe_settings &settings)
+    -> std::vector<std::size_t> {
+  auto columns = std::vector<std::vector<std::size_t>>(problem.items);
+  for (std::size_t option = 0; option < problem.options.size(); ++option)
+    for (auto item : problem.options[option])
+      columns[item].push_back(option);
+
+  auto matrix = dancing_links{problem};
+  auto order = std::vector<std::size_t>(problem.items);
+  std::iota(order.begin(), order.end(), std::size_t{0});
+  auto scores = std::vector<std::size_t>(problem.items, 0);
+  auto random = std::mt19937_64{settings.seed};
+
+  for (std::size_t probe = 0; probe < settings.probes; ++probe) {
+    std::shuffle(order.begin(), order.end(), random);
+    matrix.order_items(order);
+    for (std::size_t item = 0; item < problem.items; ++item) {
+      for (auto option : columns[item]) {
+        matrix.select(option);
+        scores[item] += matrix.tree_size(settings.node_limit);
+        matrix.deselect();
+      }
+    }
+  }
+
+  std::iota(order.begin(), order.end(), std::size_t{0});
+  std::stable_sort(order.begin(), order.end(),
+                   [&scores](auto lhs, auto rhs) {
+                     return scores[lhs] < scores[rhs];
+                   });
+  return order;
+}
+
+/// Writes the number of items on the first line and the order on the next.
+void dlx::write_item_order(std::ostream &stream,
+                           std::span<const std::size_t> order) {
+  stream << order.size() << '\n';
+  for (std::size_t i = 0; i < order.size(); ++i)
+    stream << (i == 0 ? "" : " ") << order[i];
+  stream << '\n';
+}
+
+/// Reads an item order, returning nothing if the stream does not hold a
+/// permutation of <n_items> items.
+auto dlx::read_item_order(std::istream &stream, std::size_t n_items)
+    -> std::optional<std::vector<std::size_t>> {
+  auto size = std::size_t{0};
+  if (!(stream >> size) || size != n_items)
+    return std::nullopt;
+
+  auto order = std::vector<std::size_t>(size);
+  auto seen = std::vector<bool>(size, false);
+  for (auto &item : order) {
+    if (!(stream >> item) || item >= size || seen[item])
+      return std::nullopt;
+    seen[item] = true;
+  }
+  return order;
+}
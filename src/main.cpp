@@ -21,20 +21,100 @@
 ///
 /// \file
 /// Entrance for the dancing links application. Solves a given exact cover
-/// problem.
+/// problem, or with --serve <socket>, serves solve requests on a Unix domain
+/// socket.
 ///
 //===----------------------------------------------------------------------===//
 
+#include <csignal>
+#include <charconv>
 #include <initializer_list>
 #include <iostream>
+#include <string>
+#include <string_view>
 
 #include "dancing_links.h"
+#include "instance_io.h"
+
+#if defined(DLX_POSIX)
+#include <pthread.h>
+
+#include "distributed_search.h"
+#include "solve_server.h"
+#endif
 
 using namespace dlx;
 
-#include <array>
+namespace {
+#if defined(DLX_POSIX)
+/// Serves requests on a Unix domain socket until interrupted or terminated.
+/// The signals are blocked before the server starts its threads, so that
+/// they are only received here.
+auto serve(const char *path) -> int {
+  auto signals = sigset_t{};
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+  auto server = solve_server{};
+  if (!server.listen(path)) {
+    std::cerr << "Cannot listen on " << path << '\n';
+    return 1;
+  }
+  auto signal = 0;
+  sigwait(&signals, &signal);
+  server.stop();
+  return 0;
+}
+
+/// Describes the command line, returning the exit status for bad arguments.
+auto usage(const char *program) -> int {
+  std::cerr << "Usage: " << program << " [--serve <socket> | --worker | "
+            << "--coordinate <workers>]\n";
+  return 1;
+}
+
+/// Counts the exact covers of a problem read from standard input, using
+/// <workers> copies of this executable as worker processes.
+auto coordinate(const char *program, std::string_view workers) -> int {
+  auto n_workers = std::size_t{0};
+  auto [end, error] = std::from_chars(workers.data(),
+                                      workers.data() + workers.size(),
+                                      n_workers);
+  if (error != std::errc{} || end != workers.data() + workers.size() ||
+      n_workers == 0)
+    return usage(program);
+
+  auto problem = read_instance(std::cin);
+  if (!problem) {
+    std::cerr << "Cannot parse problem\n";
+    return 1;
+  }
+  auto settings = distribution_settings{};
+  settings.workers = n_workers;
+  settings.executable = "/proc/self/exe";
+  auto count = coordinator{*problem, settings}.count();
+  if (!count) {
+    std::cerr << "All workers crashed\n";
+    return 1;
+  }
+  std::cout << *count << '\n';
+  return 0;
+}
+#endif
+} // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv) {
+#if defined(DLX_POSIX)
+  if (argc == 3 && std::string_view{argv[1]} == "--serve")
+    return serve(argv[2]);
+  if (argc == 2 && std::string_view{argv[1]} == "--worker")
+    return run_worker(0, 1) ? 0 : 1;
+  if (argc == 3 && std::string_view{argv[1]} == "--coordinate")
+    return coordinate(argv[0], argv[2]);
+#endif
 
-int main() {
   auto problem = dancing_links(4, {{1, 2}, {0}, {0, 3}, {3}});
 
   auto solutions = problem.solve();
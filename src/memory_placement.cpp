@@ -0,0 +1,188 @@
+//===-- memory_placement.cpp - Memory placement -----------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implementation of huge-page backed arenas and thread placement.
+///
+//===----------------------------------------------------------------------===//
+
+#include "memory_placement.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <new>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+using namespace dlx;
+
+namespace {
+auto round_up(std::size_t value, std::size_t multiple) -> std::size_t {
+  return (value + multiple - 1) / multiple * multiple;
+}
+} // namespace
+
+//===-- huge page resource ------------------------------------------------===//
+huge_page_resource::~huge_page_resource() {
+  for (auto [address, size] : regions) {
+#if defined(__linux__)
+    ::munmap(address, size);
+#else
+    ::operator delete(address, std::align_val_t{huge_page_size});
+#endif
+  }
+}
+
+/// Bump allocation from the current region, mapping a new region of at least
+/// twice the size of the previous one when it runs out.
+auto huge_page_resource::do_allocate(std::size_t bytes, std::size_t alignment)
+    -> void * {
+  auto padding = static_cast<std::size_t>(
+      -reinterpret_cast<std::uintptr_t>(current) & (alignment - 1));
+  if (current == nullptr || padding + bytes > remaining) {
+    auto previous = regions.empty() ? std::size_t{0} : regions.back().second;
+    map(std::max(bytes + alignment, 2 * previous));
+    padding = 0;
+  }
+  auto *result = current + padding;
+  current += padding + bytes;
+  remaining -= padding + bytes;
+  return result;
+}
+
+/// Explicit huge pages fail to map unless the administrator reserved some,
+/// in which case the region is mapped with ordinary pages instead. These are
+/// over-allocated by a huge page so that the region can be aligned to one.
+/// Elsewhere than on Linux, regions are aligned heap allocations.
+void huge_page_resource::map(std::size_t bytes) {
+  auto size = round_up(bytes, huge_page_size);
+#if defined(__linux__)
+  auto protection = PROT_READ | PROT_WRITE;
+  auto flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+  auto *address = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  address = ::mmap(nullptr, size, protection, flags | MAP_HUGETLB, -1, 0);
+  if (address != MAP_FAILED)
+    usage.explicit_pages += size;
+#endif
+  if (address == MAP_FAILED) {
+    auto *mapped = static_cast<std::byte *>(::mmap(
+        nullptr, size + huge_page_size, protection, flags, -1, 0));
+    if (static_cast<void *>(mapped) == MAP_FAILED)
+      throw std::bad_alloc{};
+    auto offset = static_cast<std::size_t>(
+        -reinterpret_cast<std::uintptr_t>(mapped) & (huge_page_size - 1));
+    if (offset != 0)
+      ::munmap(mapped, offset);
+    ::munmap(mapped + offset + size, huge_page_size - offset);
+    address = mapped + offset;
+#ifdef MADV_HUGEPAGE
+    if (::madvise(address, size, MADV_HUGEPAGE) == 0)
+      usage.advised += size;
+#endif
+  }
+#else
+  auto *address = ::operator new(size, std::align_val_t{huge_page_size});
+#endif
+
+  regions.emplace_back(address, size);
+  usage.mapped += size;
+  current = static_cast<std::byte *>(address);
+  remaining = size;
+}
+
+//===-- thread placement --------------------------------------------------===//
+/// CPUs are grouped by node, then taken from each node in turn. Without an
+/// affinity mask to consult, all hardware threads are taken to be allowed.
+auto dlx::worker_cpus(std::size_t n_threads) -> std::vector<std::size_t> {
+  auto by_node = std::map<std::size_t, std::vector<std::size_t>>{};
+#if defined(__linux__)
+  auto allowed = cpu_set_t{};
+  if (::sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+    for (std::size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+      if (CPU_ISSET(cpu, &allowed))
+        by_node[numa_node_of(cpu).value_or(0)].push_back(cpu);
+  }
+#else
+  for (std::size_t cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu)
+    by_node[numa_node_of(cpu).value_or(0)].push_back(cpu);
+#endif
+  if (by_node.empty())
+    by_node[0].push_back(0);
+
+  auto interleaved = std::vector<std::size_t>{};
+  for (std::size_t rank = 0;; ++rank) {
+    auto added = false;
+    for (const auto &[node, cpus] : by_node) {
+      if (rank < cpus.size()) {
+        interleaved.push_back(cpus[rank]);
+        added = true;
+      }
+    }
+    if (!added)
+      break;
+  }
+
+  auto result = std::vector<std::size_t>(n_threads);
+  for (std::size_t thread = 0; thread < n_threads; ++thread)
+    result[thread] = interleaved[thread % interleaved.size()];
+  return result;
+}
+
+/// Pinning is only supported on Linux.
+auto dlx::pin_to_cpu([[maybe_unused]] std::size_t cpu) -> bool {
+#if defined(__linux__)
+  if (cpu >= CPU_SETSIZE)
+    return false;
+  auto set = cpu_set_t{};
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+/// Linux lists the node of a CPU as a "node<n>" entry in its sysfs directory.
+auto dlx::numa_node_of(std::size_t cpu) -> std::optional<std::size_t> {
+  auto directory = std::filesystem::path{"/sys/devices/system/cpu"} /
+                   ("cpu" + std::to_string(cpu));
+  auto error = std::error_code{};
+  for (auto entries = std::filesystem::directory_iterator{directory, error};
+       !error && entries != std::filesystem::directory_iterator{};
+       entries.increment(error)) {
+    auto name = entries->path().filename().string();
+    if (name.size() > 4 && name.starts_with("node") &&
+        std::all_of(name.begin() + 4, name.end(),
+                    [](char c) { return c >= '0' && c <= '9'; }))
+      return std::stoul(name.substr(4));
+  }
+  return std::nullopt;
+}
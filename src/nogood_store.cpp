@@ -0,0 +1,110 @@
+//===-- nogood_store.cpp - Nogood store -------------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implementation of the bounded store of learned nogoods.
+///
+//===----------------------------------------------------------------------===//
+
+#include "nogood_store.h"
+
+#include <algorithm>
+
+using namespace dlx;
+
+//===-- nogood store ------------------------------------------------------===//
+/// Constructs an empty store.
+nogood_store::nogood_store(std::size_t budget, std::size_t max_size)
+    : budget{budget}, max_size{max_size} {}
+
+/// Inserts a nogood as the most recently used one, then evicts the least
+/// recently used nogoods until the store fits its budget again. Repeated
+/// options are dropped before the nogood is measured against the limits.
+void nogood_store::learn(std::span<const std::size_t> options) {
+  auto nogood = std::vector<std::size_t>(options.begin(), options.end());
+  std::sort(nogood.begin(), nogood.end());
+  nogood.erase(std::unique(nogood.begin(), nogood.end()), nogood.end());
+  if (nogood.empty() || nogood.size() > max_size ||
+      cost(nogood.size()) > budget || known.contains(nogood))
+    return;
+
+  nogoods.push_front(std::move(nogood));
+  auto inserted = nogoods.begin();
+  known.emplace(*inserted, inserted);
+  for (auto option : *inserted)
+    watches[option].push_back(inserted);
+  used += cost(inserted->size());
+
+  while (used > budget)
+    evict();
+}
+
+/// Checks the nogoods watching <option>.
+auto nogood_store::find(std::size_t option, const std::vector<bool> &selected)
+    -> const std::vector<std::size_t> * {
+  auto watching = watches.find(option);
+  if (watching == watches.end())
+    return nullptr;
+
+  for (auto nogood : watching->second) {
+    auto complete = std::all_of(
+        nogood->begin(), nogood->end(),
+        [&](auto other) { return other == option || selected[other]; });
+    if (complete) {
+      nogoods.splice(nogoods.begin(), nogoods, nogood);
+      ++found;
+      return &*nogood;
+    }
+  }
+  return nullptr;
+}
+
+/// FNV-1a over the option indices.
+auto nogood_store::hash::operator()(
+    const std::vector<std::size_t> &options) const noexcept -> std::size_t {
+  auto result = static_cast<std::size_t>(14695981039346656037ull);
+  for (auto option : options)
+    result = (result ^ option) * static_cast<std::size_t>(1099511628211ull);
+  return result;
+}
+
+/// Counts the options themselves, their entries in the watch lists, and the
+/// list and hash table nodes holding the nogood.
+auto nogood_store::cost(std::size_t size) -> std::size_t {
+  return 2 * size * sizeof(std::size_t) + 4 * sizeof(void *) +
+         sizeof(std::vector<std::size_t>);
+}
+
+/// Removes the least recently used nogood from the watch lists and the set
+/// of known nogoods.
+void nogood_store::evict() {
+  auto oldest = std::prev(nogoods.end());
+  for (auto option : *oldest) {
+    auto &watching = watches[option];
+    watching.erase(std::find(watching.begin(), watching.end(), oldest));
+    if (watching.empty())
+      watches.erase(option);
+  }
+  known.erase(*oldest);
+  used -= cost(oldest->size());
+  nogoods.erase(oldest);
+  ++evicted;
+}
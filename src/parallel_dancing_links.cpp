@@ -0,0 +1,237 @@
+//===-- parallel_dancing_links.cpp - Parallel search ------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implementation of the multi-threaded search for exact covers.
+///
+//===----------------------------------------------------------------------===//
+
+#include "parallel_dancing_links.h"
+
+#include <atomic>
+#include <cassert>
+
+#include "mpsc_queue.h"
+
+using namespace dlx;
+
+namespace {
+/// Prefixes are expanded until each worker can expect this many of them, so
+/// that uneven subtree sizes even out.
+constexpr std::size_t tasks_per_thread = 8;
+
+/// Bound on the depth up to which the search tree is split.
+constexpr std::size_t max_split_depth = 4;
+
+/// Number of solutions a worker buffers before handing them off.
+constexpr std::size_t batch_size = 256;
+
+/// Solutions found by a single worker, stored contiguously so that a handoff
+/// costs one allocation per batch rather than one per solution.
+struct solution_batch {
+  std::vector<std::size_t> options = {};
+  std::vector<std::size_t> ends = {};
+
+  auto size() const -> std::size_t { return ends.size(); }
+};
+
+/// Per-worker solution counter, padded to its own cache line to avoid false
+/// sharing between workers.
+struct alignas(64) counter {
+  std::size_t value = 0;
+};
+
+/// Searches the subtrees below the prefixes claimed from <next> until none
+/// remain, using a private matrix. If given a CPU, the worker is first pinned
+/// to it, so that the matrix is built on memory local to that CPU.
+void search(std::size_t n_items,
+            const std::vector<std::vector<std::size_t>> &sets,
+            const std::vector<std::vector<std::size_t>> &prefixes,
+            std::atomic<std::size_t> &next,
+            const dancing_links::visitor &visit,
+            std::optional<std::size_t> cpu, worker_placement &placement) {
+  placement = worker_placement{};
+  if (cpu && pin_to_cpu(*cpu)) {
+    placement.cpu = cpu;
+    placement.numa_node = numa_node_of(*cpu);
+  }
+
+  auto arena = huge_page_resource{};
+  auto problem = dancing_links{n_items, sets, &arena, 1};
+  for (auto task = next.fetch_add(1, std::memory_order_relaxed);
+       task < prefixes.size();
+       task = next.fetch_add(1, std::memory_order_relaxed)) {
+    for (auto index : prefixes[task])
+      problem.select(index);
+    problem.enumerate(visit);
+    for (std::size_t i = 0; i < prefixes[task].size(); ++i)
+      problem.deselect();
+  }
+  placement.memory = arena.stats();
+}
+} // namespace
+
+//===-- parallel dancing links --------------------------------------------===//
+/// Constructs an exact cover problem with a given number of items.
+parallel_dancing_links::parallel_dancing_links(
+    std::size_t n_items, std::vector<std::vector<std::size_t>> sets,
+    std::size_t n_threads)
+    : n_items{n_items}, sets{std::move(sets)},
+      n_threads{std::max(n_threads, std::size_t{1})} {}
+
+/// Constructs the exact cover problem described by an instance.
+parallel_dancing_links::parallel_dancing_links(const instance &problem,
+                                               std::size_t n_threads)
+    : parallel_dancing_links{problem.items, problem.options, n_threads} {}
+
+/// Searches the set of options to find all subsets exactly covering all given
+/// items.
+auto parallel_dancing_links::solve() -> std::vector<std::vector<std::size_t>> {
+  auto solutions = std::vector<std::vector<std::size_t>>{};
+  enumerate([&solutions](auto subset) {
+    solutions.emplace_back(subset.begin(), subset.end());
+  });
+  return solutions;
+}
+
+/// Workers fill private batches of solutions and push full batches onto a
+/// lock-free queue. The calling thread drains the queue, sleeping on an event
+/// counter that workers bump after every push and when they finish.
+void parallel_dancing_links::enumerate(const dancing_links::visitor &visit) {
+  const auto prefixes = split();
+  auto next = std::atomic<std::size_t>{0};
+  auto queue = mpsc_queue<solution_batch>{};
+  auto events = std::atomic<std::size_t>{0};
+  auto finished = std::atomic<std::size_t>{0};
+
+  auto signal = [&events] {
+    events.fetch_add(1, std::memory_order_release);
+    events.notify_one();
+  };
+
+  const auto cpus = worker_cpus(n_threads);
+  placement.resize(n_threads);
+  auto workers = std::vector<std::thread>{};
+  workers.reserve(n_threads);
+  for (std::size_t i = 0; i < n_threads; ++i) {
+    workers.emplace_back([&, i] {
+      auto batch = solution_batch{};
+      auto cpu = pinned ? std::optional{cpus[i]} : std::nullopt;
+      search(n_items, sets, prefixes, next, [&](auto subset) {
+        batch.options.insert(batch.options.end(), subset.begin(),
+                             subset.end());
+        batch.ends.push_back(batch.options.size());
+        if (batch.size() == batch_size) {
+          queue.push(std::move(batch));
+          batch = solution_batch{};
+          signal();
+        }
+      }, cpu, placement[i]);
+      if (batch.size() != 0)
+        queue.push(std::move(batch));
+      finished.fetch_add(1, std::memory_order_release);
+      signal();
+    });
+  }
+
+  auto consume = [&] {
+    while (auto batch = queue.try_pop()) {
+      auto begin = std::size_t{0};
+      for (auto end : batch->ends) {
+        visit(std::span{batch->options}.subspan(begin, end - begin));
+        begin = end;
+      }
+    }
+  };
+
+  while (true) {
+    const auto observed = events.load(std::memory_order_acquire);
+    consume();
+    if (finished.load(std::memory_order_acquire) == n_threads) {
+      consume();
+      break;
+    }
+    events.wait(observed, std::memory_order_acquire);
+  }
+
+  for (auto &worker : workers)
+    worker.join();
+}
+
+/// Counts all subsets exactly covering all given items. Each worker counts
+/// into its own cache line; counts are only combined after joining.
+auto parallel_dancing_links::count() -> std::size_t {
+  const auto prefixes = split();
+  auto next = std::atomic<std::size_t>{0};
+  auto counters = std::vector<counter>(n_threads);
+
+  const auto cpus = worker_cpus(n_threads);
+  placement.resize(n_threads);
+  auto workers = std::vector<std::thread>{};
+  workers.reserve(n_threads);
+  for (std::size_t i = 0; i < n_threads; ++i) {
+    workers.emplace_back([&, i] {
+      auto cpu = pinned ? std::optional{cpus[i]} : std::nullopt;
+      search(n_items, sets, prefixes, next,
+             [&counter = counters[i]](auto) { ++counter.value; }, cpu,
+             placement[i]);
+    });
+  }
+  for (auto &worker : workers)
+    worker.join();
+
+  auto total = std::size_t{0};
+  for (const auto &counter : counters)
+    total += counter.value;
+  return total;
+}
+
+/// Expands prefixes breadth-first by the options covering the item the
+/// sequential search would branch on. Prefixes that cannot be expanded are
+/// either exact covers or dead ends; both are left for the workers.
+auto parallel_dancing_links::split() const
+    -> std::vector<std::vector<std::size_t>> {
+  auto problem = dancing_links{n_items, sets};
+  auto prefixes = std::vector<std::vector<std::size_t>>{{}};
+
+  for (std::size_t depth = 0; depth < max_split_depth &&
+                              prefixes.size() < n_threads * tasks_per_thread;
+       ++depth) {
+    auto expanded = std::vector<std::vector<std::size_t>>{};
+    for (const auto &prefix : prefixes) {
+      for (auto index : prefix)
+        problem.select(index);
+
+      auto branches = problem.candidates();
+      if (branches.empty())
+        expanded.push_back(prefix);
+      for (auto branch : branches) {
+        expanded.push_back(prefix);
+        expanded.back().push_back(branch);
+      }
+
+      for (std::size_t i = 0; i < prefix.size(); ++i)
+        problem.deselect();
+    }
+    prefixes = std::move(expanded);
+  }
+  return prefixes;
+}
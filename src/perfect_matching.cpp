@@ -0,0 +1,238 @@
+//===-- perfect_matching.cpp - Perfect matchings ----------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implements Edmonds' blossom algorithm and the counting of perfect matchings.
+///
+//===----------------------------------------------------------------------===//
+
+#include "perfect_matching.h"
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+
+using namespace dlx;
+
+namespace {
+constexpr auto none = static_cast<std::size_t>(-1);
+
+/// State of the search for augmenting paths, following the formulation in
+/// which blossoms are contracted implicitly by relabelling their bases.
+class blossom_matching {
+public:
+  blossom_matching(std::size_t vertices, std::span<const edge> edges)
+      : adjacent(vertices), match(vertices, none), parent(vertices),
+        base(vertices), used(vertices), in_blossom(vertices) {
+    for (auto [a, b] : edges) {
+      if (a == b)
+        continue;
+      adjacent[a].push_back(b);
+      adjacent[b].push_back(a);
+    }
+  }
+
+  /// Matches every vertex, returning false if that is impossible. A vertex
+  /// left exposed by a search without augmenting path stays exposed under
+  /// any later augmentation, so the first failure is final.
+  auto match_all() -> bool {
+    for (std::size_t v = 0; v < match.size(); ++v)
+      for (auto to : adjacent[v])
+        if (match[v] == none && match[to] == none) {
+          match[v] = to;
+          match[to] = v;
+        }
+    for (std::size_t root = 0; root < match.size(); ++root) {
+      if (match[root] != none)
+        continue;
+      auto end = augmenting_path(root);
+      if (end == none)
+        return false;
+      while (end != none) {
+        auto next = match[parent[end]];
+        match[end] = parent[end];
+        match[parent[end]] = end;
+        end = next;
+      }
+    }
+    return true;
+  }
+
+  /// Partner of each vertex.
+  auto partners() const -> const std::vector<std::size_t> & { return match; }
+
+private:
+  /// Lowest common ancestor of the bases of <a> and <b> in the alternating
+  /// forest.
+  auto common_base(std::size_t a, std::size_t b) -> std::size_t {
+    auto seen = std::vector<bool>(match.size());
+    while (true) {
+      a = base[a];
+      seen[a] = true;
+      if (match[a] == none)
+        break;
+      a = parent[match[a]];
+    }
+    while (true) {
+      b = base[b];
+      if (seen[b])
+        return b;
+      b = parent[match[b]];
+    }
+  }
+
+  /// Marks the blossom vertices on the path from <v> down to <blossom_base>,
+  /// pointing their parents back around the blossom.
+  void mark_path(std::size_t v, std::size_t blossom_base, std::size_t child) {
+    while (base[v] != blossom_base) {
+      in_blossom[base[v]] = in_blossom[base[match[v]]] = true;
+      parent[v] = child;
+      child = match[v];
+      v = parent[match[v]];
+    }
+  }
+
+  /// Grows an alternating tree from <root>, returning the exposed vertex at
+  /// the end of an augmenting path, or <none>.
+  auto augmenting_path(std::size_t root) -> std::size_t {
+    std::fill(used.begin(), used.end(), false);
+    std::fill(parent.begin(), parent.end(), none);
+    for (std::size_t v = 0; v < base.size(); ++v)
+      base[v] = v;
+    used[root] = true;
+    auto queue = std::vector<std::size_t>{root};
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+      auto v = queue[head];
+      for (auto to : adjacent[v]) {
+        if (base[v] == base[to] || match[v] == to)
+          continue;
+        if (to == root || (match[to] != none && parent[match[to]] != none)) {
+          auto blossom_base = common_base(v, to);
+          std::fill(in_blossom.begin(), in_blossom.end(), false);
+          mark_path(v, blossom_base, to);
+          mark_path(to, blossom_base, v);
+          for (std::size_t i = 0; i < base.size(); ++i) {
+            if (!in_blossom[base[i]])
+              continue;
+            base[i] = blossom_base;
+            if (!used[i]) {
+              used[i] = true;
+              queue.push_back(i);
+            }
+          }
+        } else if (parent[to] == none) {
+          parent[to] = v;
+          if (match[to] == none)
+            return to;
+          used[match[to]] = true;
+          queue.push_back(match[to]);
+        }
+      }
+    }
+    return none;
+  }
+
+  std::vector<std::vector<std::size_t>> adjacent;
+  std::vector<std::size_t> match;
+  std::vector<std::size_t> parent;
+  std::vector<std::size_t> base;
+  std::vector<bool> used;
+  std::vector<bool> in_blossom;
+};
+
+/// Hashes the set of matched vertices above the lowest unmatched one.
+struct frontier_hash {
+  auto operator()(const std::vector<std::size_t> &matched) const noexcept
+      -> std::size_t {
+    auto hash = std::size_t{14695981039346656037ull};
+    for (auto v : matched)
+      hash = (hash ^ v) * 1099511628211ull;
+    return hash;
+  }
+};
+
+/// Number of partial matchings reaching each set of matched vertices.
+using frontier_counts =
+    std::unordered_map<std::vector<std::size_t>, std::size_t, frontier_hash>;
+} // namespace
+
+auto dlx::find_perfect_matching(std::size_t vertices,
+                                std::span<const edge> edges)
+    -> std::optional<std::vector<std::size_t>> {
+  if (vertices % 2 != 0)
+    return {};
+  auto matching = blossom_matching{vertices, edges};
+  if (!matching.match_all())
+    return {};
+
+  auto &partner = matching.partners();
+  auto taken = std::vector<bool>(vertices);
+  auto result = std::vector<std::size_t>{};
+  for (std::size_t i = 0; i < edges.size(); ++i) {
+    auto [a, b] = edges[i];
+    if (a != b && partner[a] == b && !taken[a]) {
+      taken[a] = taken[b] = true;
+      result.push_back(i);
+    }
+  }
+  return result;
+}
+
+auto dlx::count_perfect_matchings(std::size_t vertices,
+                                  std::span<const edge> edges,
+                                  const std::function<bool()> &stop)
+    -> std::size_t {
+  if (vertices % 2 != 0)
+    return 0;
+  auto above = std::vector<std::vector<std::size_t>>(vertices);
+  for (auto [a, b] : edges)
+    if (a != b)
+      above[std::min(a, b)].push_back(std::max(a, b));
+
+  // Partial matchings by their lowest unmatched vertex, which only grows.
+  auto pending = std::map<std::size_t, frontier_counts>{};
+  pending[0][{}] = 1;
+  while (!pending.empty()) {
+    auto lowest = pending.extract(pending.begin());
+    auto v = lowest.key();
+    if (v == vertices)
+      return lowest.mapped()[{}];
+    for (const auto &[matched, ways] : lowest.mapped()) {
+      if (stop && stop())
+        return 0;
+      for (auto u : above[v]) {
+        if (std::binary_search(matched.begin(), matched.end(), u))
+          continue;
+        auto next = matched;
+        next.insert(std::upper_bound(next.begin(), next.end(), u), u);
+        auto w = v + 1;
+        auto skipped = std::size_t{0};
+        while (skipped < next.size() && next[skipped] == w) {
+          ++skipped;
+          ++w;
+        }
+        next.erase(next.begin(), next.begin() + skipped);
+        pending[w][std::move(next)] += ways;
+      }
+    }
+  }
+  return 0;
+}
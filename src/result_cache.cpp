@@ -0,0 +1,242 @@
+//===-- result_cache.cpp - Solve result cache -------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implementation of the cache of solve results keyed by canonical form.
+///
+//===----------------------------------------------------------------------===//
+
+#include "result_cache.h"
+
+#include <charconv>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+using namespace dlx;
+
+namespace {
+/// Distinguishes the results of different modes for the same problem.
+auto key_of(std::uint64_t hash, solve_mode mode) -> std::uint64_t {
+  return hash ^ (static_cast<std::uint64_t>(mode) + 1) * 0x9e3779b97f4a7c15;
+}
+
+/// Names a file next to <target> that no other thread or process writes, by
+/// appending a random nonce drawn from a generator private to the thread.
+auto temporary_path(const std::filesystem::path &target)
+    -> std::filesystem::path {
+  thread_local auto generator = std::mt19937_64{std::random_device{}()};
+  auto name = std::ostringstream{};
+  name << target.filename().string() << '.' << std::hex << generator()
+       << ".tmp";
+  return target.parent_path() / name.str();
+}
+
+auto same(const instance &left, const instance &right) -> bool {
+  return left.items == right.items && left.options == right.options;
+}
+
+/// Sets are written as their size followed by their elements.
+/// @{
+void write_set(std::ostream &stream, const std::vector<std::size_t> &set) {
+  stream << set.size();
+  for (auto element : set)
+    stream << ' ' << element;
+  stream << '\n';
+}
+
+auto read_set(std::istream &stream, std::vector<std::size_t> &set) -> bool {
+  auto size = std::size_t{0};
+  if (!(stream >> size))
+    return false;
+  set.resize(size);
+  for (auto &element : set)
+    if (!(stream >> element))
+      return false;
+  return true;
+}
+/// @}
+
+/// Entries are stored as a header line with the mode, count and number of
+/// solutions, then the solutions, then the item count, the number of options
+/// and the options of the canonical problem.
+/// @{
+constexpr auto magic = "dlx-result";
+
+void write_entry(std::ostream &stream, const instance &problem,
+                 solve_mode mode, const batch_result &result) {
+  stream << magic << ' ' << static_cast<int>(mode) << ' ' << result.count
+         << ' ' << result.solutions.size() << '\n';
+  for (const auto &solution : result.solutions)
+    write_set(stream, solution);
+  stream << problem.items << ' ' << problem.options.size() << '\n';
+  for (const auto &option : problem.options)
+    write_set(stream, option);
+}
+
+auto read_entry(std::istream &stream, instance &problem, solve_mode &mode,
+                batch_result &result) -> bool {
+  auto header = std::string{};
+  auto mode_value = 0;
+  auto n_solutions = std::size_t{0};
+  if (!(stream >> header >> mode_value >> result.count >> n_solutions) ||
+      header != magic || mode_value < 0 || mode_value > 2)
+    return false;
+  mode = static_cast<solve_mode>(mode_value);
+  result.solutions.resize(n_solutions);
+  for (auto &solution : result.solutions)
+    if (!read_set(stream, solution))
+      return false;
+
+  auto n_options = std::size_t{0};
+  if (!(stream >> problem.items >> n_options))
+    return false;
+  problem.options.resize(n_options);
+  for (auto &option : problem.options)
+    if (!read_set(stream, option))
+      return false;
+  return true;
+}
+/// @}
+} // namespace
+
+//===-- result cache ------------------------------------------------------===//
+/// Creates the cache directory if it does not exist yet. Should that fail,
+/// the cache silently works from memory only.
+result_cache::result_cache(std::size_t capacity,
+                           std::filesystem::path directory)
+    : capacity{capacity}, directory{std::move(directory)} {
+  if (!this->directory.empty()) {
+    auto error = std::error_code{};
+    std::filesystem::create_directories(this->directory, error);
+    if (error)
+      this->directory.clear();
+  }
+}
+
+/// Falls back on a result for all solutions if none was cached for <mode>.
+auto result_cache::lookup(const canonical_instance &form, solve_mode mode)
+    -> std::optional<batch_result> {
+  auto found = find(form, mode);
+  if (!found && mode != solve_mode::all)
+    found = find(form, solve_mode::all);
+  {
+    auto lock = std::lock_guard{mutex};
+    ++(found ? n_hits : n_misses);
+  }
+  if (!found)
+    return std::nullopt;
+
+  const auto &cached = found->result;
+  auto result = batch_result{};
+  result.count = cached.count;
+  switch (mode) {
+  case solve_mode::first:
+    if (!cached.solutions.empty())
+      result.solutions.push_back(form.original(cached.solutions.front()));
+    result.count = result.solutions.size();
+    break;
+  case solve_mode::all:
+    for (const auto &solution : cached.solutions)
+      result.solutions.push_back(form.original(solution));
+    break;
+  case solve_mode::count:
+    break;
+  }
+  return result;
+}
+
+void result_cache::store(const canonical_instance &form, solve_mode mode,
+                         const batch_result &result) {
+  auto key = key_of(form.hash, mode);
+  if (!directory.empty()) {
+    // Written under a private name, then renamed into place, so that readers
+    // never see a partially written entry.
+    auto target = path(key);
+    auto temporary = temporary_path(target);
+    {
+      auto file = std::ofstream{temporary};
+      write_entry(file, form.problem, mode, result);
+    }
+    auto error = std::error_code{};
+    std::filesystem::rename(temporary, target, error);
+    if (error)
+      std::filesystem::remove(temporary, error);
+  }
+  insert({key, form.problem, mode, result});
+}
+
+auto result_cache::hits() const -> std::size_t {
+  auto lock = std::lock_guard{mutex};
+  return n_hits;
+}
+
+auto result_cache::misses() const -> std::size_t {
+  auto lock = std::lock_guard{mutex};
+  return n_misses;
+}
+
+/// Entries found on disk are brought into memory. The disk is read without
+/// holding the lock, so that workers do not wait on each other's reads.
+auto result_cache::find(const canonical_instance &form, solve_mode mode)
+    -> std::optional<entry> {
+  auto key = key_of(form.hash, mode);
+  {
+    auto lock = std::lock_guard{mutex};
+    if (auto position = index.find(key); position != index.end()) {
+      if (!same(position->second->problem, form.problem))
+        return std::nullopt;
+      recent.splice(recent.begin(), recent, position->second);
+      return *position->second;
+    }
+  }
+  if (directory.empty())
+    return std::nullopt;
+
+  auto file = std::ifstream{path(key)};
+  auto value = entry{key, {}, mode, {}};
+  if (!file || !read_entry(file, value.problem, value.mode, value.result) ||
+      value.mode != mode || !same(value.problem, form.problem))
+    return std::nullopt;
+  insert(value);
+  return value;
+}
+
+void result_cache::insert(entry value) {
+  auto lock = std::lock_guard{mutex};
+  if (auto position = index.find(value.key); position != index.end()) {
+    recent.erase(position->second);
+    index.erase(position);
+  }
+  recent.push_front(std::move(value));
+  index.emplace(recent.front().key, recent.begin());
+  while (recent.size() > capacity) {
+    index.erase(recent.back().key);
+    recent.pop_back();
+  }
+}
+
+/// Entries are named after their key in hexadecimal.
+auto result_cache::path(std::uint64_t key) const -> std::filesystem::path {
+  char name[17] = {};
+  std::to_chars(name, name + 16, key, 16);
+  return directory / (std::string{name} + ".dlx");
+}
@@ -0,0 +1,65 @@
+//===-- socket_io.cpp - Socket I/O helpers ----------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implementation of blocking reads and writes of whole messages.
+///
+//===----------------------------------------------------------------------===//
+
+#include "socket_io.h"
+
+#include <cerrno>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace dlx;
+
+io::descriptor::~descriptor() {
+  if (fd >= 0)
+    ::close(fd);
+}
+
+/// Retries reads interrupted by signals.
+auto io::read_exact(int fd, std::uint8_t *data, std::size_t size) -> bool {
+  while (size != 0) {
+    auto n = ::read(fd, data, size);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    data += n;
+    size -= static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+auto io::write_all(int fd, std::span<const std::uint8_t> data) -> bool {
+  while (!data.empty()) {
+    auto n = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    data = data.subspan(static_cast<std::size_t>(n));
+  }
+  return true;
+}
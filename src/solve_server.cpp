@@ -0,0 +1,342 @@
+//===-- solve_server.cpp - Unix socket solve server -------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implementation of the server solving problems sent over a Unix domain
+/// socket.
+///
+//===----------------------------------------------------------------------===//
+
+#include "solve_server.h"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "instance_io.h"
+#include "socket_io.h"
+#include "wire.h"
+
+using namespace dlx;
+using io::read_exact;
+using io::write_all;
+
+namespace {
+/// Replies are written out whenever this much of them has been encoded.
+constexpr std::size_t chunk_size = std::size_t{64} << 10;
+
+/// Size of a request header and of a reply header.
+/// @{
+constexpr std::size_t request_header = 12;
+constexpr std::size_t reply_header = 16;
+/// @}
+
+/// Fills in the address of a socket at <path>, if the path fits.
+auto address_of(const std::filesystem::path &path, sockaddr_un &address)
+    -> bool {
+  const auto &name = path.native();
+  if (name.size() >= sizeof(address.sun_path))
+    return false;
+  address = {};
+  address.sun_family = AF_UNIX;
+  std::memcpy(address.sun_path, name.c_str(), name.size() + 1);
+  return true;
+}
+
+/// Encodes a reply, sending it in chunks of about <chunk_size> bytes.
+auto send_reply(int connection, reply_status status,
+                const batch_result &result, std::size_t max_solutions)
+    -> bool {
+  auto sent = std::min(result.solutions.size(), max_solutions);
+  if (sent < result.solutions.size())
+    status = reply_status::truncated;
+
+  auto buffer = std::vector<std::uint8_t>{};
+  buffer.reserve(chunk_size);
+  wire::put<4>(buffer, static_cast<std::uint32_t>(status));
+  wire::put<8>(buffer, result.count);
+  wire::put<4>(buffer, sent);
+  for (std::size_t i = 0; i < sent; ++i) {
+    wire::put<4>(buffer, result.solutions[i].size());
+    for (auto option : result.solutions[i])
+      wire::put<4>(buffer, option);
+    if (buffer.size() >= chunk_size) {
+      if (!write_all(connection, buffer))
+        return false;
+      buffer.clear();
+    }
+  }
+  return write_all(connection, buffer);
+}
+} // namespace
+
+//===-- solve server ------------------------------------------------------===//
+/// Connection threads start right away and wait for connections.
+solve_server::solve_server(std::size_t n_threads, server_limits limits)
+    : solver{n_threads}, limits{limits} {
+  this->limits.max_connections = std::max(limits.max_connections,
+                                          std::size_t{1});
+  connection_threads.reserve(this->limits.max_connections);
+  for (std::size_t i = 0; i < this->limits.max_connections; ++i)
+    connection_threads.emplace_back([this] { serve_connections(); });
+}
+
+solve_server::~solve_server() { stop(); }
+
+/// Only a socket file left at <path> is removed; any other file there makes
+/// listening fail.
+auto solve_server::listen(const std::filesystem::path &path) -> bool {
+  auto address = sockaddr_un{};
+  if (listener >= 0 || !address_of(path, address))
+    return false;
+  struct stat existing = {};
+  if (::lstat(path.c_str(), &existing) == 0) {
+    if (!S_ISSOCK(existing.st_mode) || ::unlink(path.c_str()) != 0)
+      return false;
+  } else if (errno != ENOENT) {
+    return false;
+  }
+
+  auto fail = [this] {
+    for (auto *fd : {&listener, &wakeup[0], &wakeup[1]}) {
+      if (*fd >= 0)
+        ::close(*fd);
+      *fd = -1;
+    }
+    return false;
+  };
+  if (::pipe2(wakeup.data(), O_CLOEXEC) != 0)
+    return fail();
+  listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listener < 0 ||
+      ::bind(listener, reinterpret_cast<sockaddr *>(&address),
+             sizeof(address)) != 0 ||
+      ::listen(listener, SOMAXCONN) != 0)
+    return fail();
+  socket_path = path;
+  acceptor = std::thread{[this] { accept_connections(); }};
+  return true;
+}
+
+/// Wakes the accepting thread through its pipe, as closing a listening
+/// socket does not reliably interrupt a blocked accept.
+void solve_server::stop() {
+  {
+    auto lock = std::lock_guard{mutex};
+    if (stopping)
+      return;
+    stopping = true;
+    cancelled = true;
+    for (auto connection : active)
+      ::shutdown(connection, SHUT_RDWR);
+    for (auto connection : pending)
+      ::close(connection);
+    pending.clear();
+  }
+  changed.notify_all();
+
+  if (acceptor.joinable()) {
+    auto byte = std::uint8_t{0};
+    [[maybe_unused]] auto written = ::write(wakeup[1], &byte, 1);
+    acceptor.join();
+  }
+  for (auto &thread : connection_threads)
+    thread.join();
+
+  if (listener >= 0) {
+    ::close(listener);
+    ::unlink(socket_path.c_str());
+  }
+  for (auto fd : wakeup)
+    if (fd >= 0)
+      ::close(fd);
+}
+
+/// Only accepts a connection once a connection thread is free to serve it,
+/// so that excess clients queue up in the listen backlog.
+void solve_server::accept_connections() {
+  auto descriptors = std::array<pollfd, 2>{{{listener, POLLIN, 0},
+                                            {wakeup[0], POLLIN, 0}}};
+  while (true) {
+    {
+      auto lock = std::unique_lock{mutex};
+      changed.wait(lock, [this] {
+        return stopping ||
+               pending.size() + active.size() < limits.max_connections;
+      });
+      if (stopping)
+        return;
+    }
+
+    if (::poll(descriptors.data(), descriptors.size(), -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      return;
+    }
+    if (descriptors[1].revents != 0)
+      return;
+    auto connection = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+    if (connection < 0)
+      continue;
+
+    {
+      auto lock = std::lock_guard{mutex};
+      if (stopping) {
+        ::close(connection);
+        return;
+      }
+      pending.push_back(connection);
+    }
+    changed.notify_all();
+  }
+}
+
+void solve_server::serve_connections() {
+  while (true) {
+    auto connection = -1;
+    {
+      auto lock = std::unique_lock{mutex};
+      changed.wait(lock, [this] { return stopping || !pending.empty(); });
+      if (stopping)
+        return;
+      connection = pending.front();
+      pending.pop_front();
+      active.insert(connection);
+    }
+
+    serve(connection);
+    {
+      auto lock = std::lock_guard{mutex};
+      active.erase(connection);
+    }
+    ::close(connection);
+    changed.notify_all();
+  }
+}
+
+/// Requests that cannot be decoded or exceed the limits are answered with an
+/// error status. If the header itself is invalid, the connection is closed,
+/// as the start of the next request can no longer be found.
+void solve_server::serve(int connection) {
+  auto header = std::array<std::uint8_t, request_header>{};
+  auto payload = std::vector<std::uint8_t>{};
+  while (read_exact(connection, header.data(), header.size())) {
+    auto offset = std::size_t{0};
+    auto request_magic = *wire::get<4>(header, offset);
+    auto mode = *wire::get<4>(header, offset);
+    auto size = *wire::get<4>(header, offset);
+    if (request_magic != magic || mode > 2) {
+      send_reply(connection, reply_status::malformed, {}, 0);
+      return;
+    }
+    if (size > limits.max_request_bytes) {
+      send_reply(connection, reply_status::too_large, {}, 0);
+      return;
+    }
+
+    payload.resize(size);
+    if (!read_exact(connection, payload.data(), payload.size()))
+      return;
+    auto problem = decode_instance(payload);
+    auto status = reply_status::ok;
+    auto result = batch_result{};
+    if (!problem) {
+      status = reply_status::malformed;
+    } else if (problem->items > limits.max_items ||
+               problem->options.size() > limits.max_options) {
+      status = reply_status::too_large;
+    } else {
+      auto budget = search_budget{
+          limits.max_nodes,
+          std::chrono::steady_clock::now() + limits.max_time, &cancelled};
+      result = solver
+                   .submit(std::move(*problem), static_cast<solve_mode>(mode),
+                           limits.max_solutions, budget)
+                   .get();
+      if (!result.complete)
+        status = reply_status::exhausted;
+      else if (result.solutions.size() < result.count &&
+               static_cast<solve_mode>(mode) == solve_mode::all)
+        status = reply_status::truncated;
+    }
+    if (!send_reply(connection, status, result, limits.max_solutions))
+      return;
+  }
+}
+
+//===-- client ------------------------------------------------------------===//
+auto dlx::request_solve(const std::filesystem::path &path,
+                        const instance &problem, solve_mode mode)
+    -> std::optional<server_reply> {
+  auto address = sockaddr_un{};
+  auto socket =
+      io::descriptor{::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+  if (socket.get() < 0 || !address_of(path, address) ||
+      ::connect(socket.get(), reinterpret_cast<sockaddr *>(&address),
+                sizeof(address)) != 0)
+    return std::nullopt;
+
+  auto payload = encode_instance(problem);
+  auto request = std::vector<std::uint8_t>{};
+  wire::put<4>(request, solve_server::magic);
+  wire::put<4>(request, static_cast<std::uint32_t>(mode));
+  wire::put<4>(request, payload.size());
+  request.insert(request.end(), payload.begin(), payload.end());
+  if (!write_all(socket.get(), request))
+    return std::nullopt;
+
+  auto header = std::array<std::uint8_t, reply_header>{};
+  if (!read_exact(socket.get(), header.data(), header.size()))
+    return std::nullopt;
+  auto offset = std::size_t{0};
+  auto reply = server_reply{};
+  reply.status = static_cast<reply_status>(*wire::get<4>(header, offset));
+  reply.count = *wire::get<8>(header, offset);
+  reply.solutions.resize(*wire::get<4>(header, offset));
+
+  auto word = std::array<std::uint8_t, 4>{};
+  auto next = [&]() -> std::optional<std::size_t> {
+    auto position = std::size_t{0};
+    if (!read_exact(socket.get(), word.data(), word.size()))
+      return std::nullopt;
+    return wire::get<4>(word, position);
+  };
+  for (auto &solution : reply.solutions) {
+    auto size = next();
+    if (!size)
+      return std::nullopt;
+    solution.resize(*size);
+    for (auto &option : solution) {
+      auto value = next();
+      if (!value)
+        return std::nullopt;
+      option = *value;
+    }
+  }
+  return reply;
+}
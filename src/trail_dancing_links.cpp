@@ -0,0 +1,263 @@
+//===-- trail_dancing_links.cpp - Undo-trail search -------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implementation of the exact cover search on flat index arrays with an undo
+/// trail.
+///
+//===----------------------------------------------------------------------===//
+
+#include "trail_dancing_links.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <unordered_map>
+
+using namespace dlx;
+
+//===-- trail dancing links -----------------------------------------------===//
+/// Lays out the matrix. Nodes 0 to n_items - 1 head the item lists, followed
+/// by the nodes of each option in turn. Item n_items is the root of the list
+/// of uncovered items.
+trail_dancing_links::trail_dancing_links(
+    std::size_t n_items, const std::vector<std::vector<std::size_t>> &sets)
+    : n_items{static_cast<index>(n_items)},
+      n_nodes{static_cast<index>(n_items)} {
+  for (const auto &set : sets)
+    n_nodes += static_cast<index>(set.size());
+  assert(3 * (n_items + 1) + 2 * std::size_t{n_nodes} <
+         std::numeric_limits<index>::max());
+
+  state.resize(3 * (n_items + 1) + 2 * std::size_t{n_nodes});
+  for (index item = 0; item <= this->n_items; ++item) {
+    state[left(item)] = item == 0 ? this->n_items : item - 1;
+    state[right(item)] = item == this->n_items ? 0 : item + 1;
+  }
+
+  top.resize(n_nodes);
+  owner.resize(n_nodes);
+  for (index item = 0; item < this->n_items; ++item) {
+    top[item] = item;
+    state[up(item)] = state[down(item)] = item;
+  }
+
+  auto node = this->n_items;
+  for (const auto &set : sets) {
+    first.push_back(node);
+    for (auto item : set) {
+      auto column = static_cast<index>(item);
+      top[node] = column;
+      owner[node] = static_cast<index>(first.size() - 1);
+      state[up(node)] = state[up(column)];
+      state[down(node)] = column;
+      state[down(state[up(column)])] = node;
+      state[up(column)] = node;
+      state[size(column)] += 1;
+      ++node;
+    }
+  }
+  first.push_back(node);
+}
+
+/// Constructs the exact cover problem described by an instance.
+trail_dancing_links::trail_dancing_links(const instance &problem)
+    : trail_dancing_links{problem.items, problem.options} {}
+
+/// Searches the set of options to find all subsets exactly covering all given
+/// items.
+auto trail_dancing_links::solve() -> std::vector<std::vector<std::size_t>> {
+  auto solutions = std::vector<std::vector<std::size_t>>{};
+  enumerate([&solutions](auto subset) {
+    solutions.emplace_back(subset.begin(), subset.end());
+  });
+  return solutions;
+}
+
+/// Recursively searches the set of options to find a subset exactly
+/// covering all given items.
+auto trail_dancing_links::quicksolve() -> std::vector<std::size_t> {
+  auto item = next_candidate();
+  if (item == n_items)
+    return current_subset;
+
+  const auto depth = current_subset.size();
+  for (auto node = state[down(item)]; node != item; node = state[down(node)]) {
+    select(owner[node]);
+    auto result = quicksolve();
+    rollback(depth);
+    if (!result.empty())
+      return result;
+  }
+  return {};
+}
+
+/// Recursively searches the set of options to find all subsets exactly
+/// covering all given items. Branches are undone by unwinding the trail,
+/// which leaves the item list being traversed untouched.
+void trail_dancing_links::enumerate(const dancing_links::visitor &visit) {
+  auto item = next_candidate();
+  if (item == n_items) {
+    visit(current_subset);
+    return;
+  }
+
+  const auto depth = current_subset.size();
+  for (auto node = state[down(item)]; node != item; node = state[down(node)]) {
+    select(owner[node]);
+    enumerate(visit);
+    rollback(depth);
+  }
+}
+
+/// Counts all subsets exactly covering all given items.
+auto trail_dancing_links::count() -> std::size_t {
+  auto total = std::size_t{0};
+  enumerate([&total](auto) { ++total; });
+  return total;
+}
+
+/// Selects an option by covering all of its items, remembering where on the
+/// trail the selection started.
+void trail_dancing_links::select(std::size_t option) {
+  marks.push_back(trail.size());
+  current_subset.push_back(option);
+  for (auto node = first[option]; node != first[option + 1]; ++node)
+    cover(top[node]);
+}
+
+/// Unwinds the trail down to the mark left by selection number <depth>.
+/// Depths below that of an imported state cannot be restored individually;
+/// only the initial state can.
+void trail_dancing_links::rollback(std::size_t depth) {
+  if (depth >= current_subset.size())
+    return;
+  assert(depth == 0 || depth >= imported_depth);
+
+  const auto mark = depth < imported_depth ? 0 : marks[depth];
+  while (trail.size() > mark) {
+    state[trail.back().slot] = trail.back().value;
+    trail.pop_back();
+  }
+  marks.resize(depth);
+  current_subset.resize(depth);
+  imported_depth = std::min(imported_depth, depth);
+}
+
+/// Returns the indices of the options covering the next item to be covered.
+auto trail_dancing_links::candidates() const -> std::vector<std::size_t> {
+  auto result = std::vector<std::size_t>{};
+  auto item = next_candidate();
+  if (item == n_items)
+    return result;
+
+  for (auto node = state[down(item)]; node != item; node = state[down(node)])
+    result.push_back(owner[node]);
+  return result;
+}
+
+/// Reconstructs the value each slot had at the mark of <depth>: slots written
+/// later hold their earliest overwritten value, others their current value.
+/// Only slots that differ from their initial value are exported.
+auto trail_dancing_links::export_state(std::size_t depth) const
+    -> search_state {
+  assert(depth <= current_subset.size());
+  const auto mark = depth == current_subset.size() ? trail.size()
+                    : depth < imported_depth        ? 0
+                                                    : marks[depth];
+
+  auto at_mark = std::unordered_map<index, index>{};
+  for (auto entry = trail.size(); entry-- > mark;)
+    at_mark[trail[entry].slot] = trail[entry].value;
+
+  auto initial = std::unordered_map<index, index>{};
+  for (auto entry = mark; entry-- > 0;)
+    initial[trail[entry].slot] = trail[entry].value;
+
+  auto result = search_state{};
+  result.selection.assign(current_subset.begin(),
+                          current_subset.begin() + depth);
+  for (auto [slot, value] : initial) {
+    auto later = at_mark.find(slot);
+    auto current = later == at_mark.end() ? state[slot] : later->second;
+    if (current != value)
+      result.entries.push_back({slot, current});
+  }
+  std::sort(result.entries.begin(), result.entries.end(),
+            [](auto lhs, auto rhs) { return lhs.slot < rhs.slot; });
+  return result;
+}
+
+/// Replays exported writes onto the initial state. The writes are logged on
+/// the trail like any other, so that the import can be undone.
+void trail_dancing_links::import_state(const search_state &state) {
+  assert(trail.empty() && current_subset.empty());
+  for (auto entry : state.entries)
+    assign(entry.slot, entry.value);
+  current_subset = state.selection;
+  marks.assign(current_subset.size(), 0);
+  imported_depth = current_subset.size();
+}
+
+/// Writes a slot, logging the overwritten value on the trail.
+void trail_dancing_links::assign(index slot, index value) {
+  trail.push_back({slot, state[slot]});
+  state[slot] = value;
+}
+
+/// Covers an item by hiding all options containing it, then unlinking it from
+/// the list of uncovered items.
+void trail_dancing_links::cover(index item) {
+  for (auto node = state[down(item)]; node != item; node = state[down(node)])
+    hide(node);
+
+  auto previous = state[left(item)];
+  auto next = state[right(item)];
+  assign(right(previous), next);
+  assign(left(next), previous);
+}
+
+/// Unlinks the nodes of an option, other than <node> itself, from their item
+/// lists.
+void trail_dancing_links::hide(index node) {
+  const auto option = owner[node];
+  for (auto other = first[option]; other != first[option + 1]; ++other) {
+    if (other == node)
+      continue;
+    auto above = state[up(other)];
+    auto below = state[down(other)];
+    assign(down(above), below);
+    assign(up(below), above);
+    assign(size(top[other]), state[size(top[other])] - 1);
+  }
+}
+
+/// Returns the uncovered item with the fewest options, or the root if all
+/// items are covered.
+auto trail_dancing_links::next_candidate() const -> index {
+  auto best = n_items;
+  for (auto item = state[right(n_items)]; item != n_items;
+       item = state[right(item)]) {
+    if (best == n_items || state[size(item)] < state[size(best)])
+      best = item;
+  }
+  return best;
+}
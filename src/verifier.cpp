@@ -0,0 +1,124 @@
+//===-- verifier.cpp - Solution verifier ------------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Implementation of the independent validation of exact covers.
+///
+//===----------------------------------------------------------------------===//
+
+#include "verifier.h"
+
+#include <bit>
+#include <map>
+
+using namespace dlx;
+
+//===-- verifier ----------------------------------------------------------===//
+/// Groups the items of each option by bitset word. <weight> holds the number
+/// of distinct items an option covers.
+verifier::verifier(const instance &problem) : n_items{problem.items} {
+  first.reserve(problem.options.size() + 1);
+  weight.reserve(problem.options.size());
+  for (const auto &option : problem.options) {
+    first.push_back(chunks.size());
+    auto words = std::map<std::size_t, std::uint64_t>{};
+    for (auto item : option)
+      words[item / 64] |= std::uint64_t{1} << (item % 64);
+
+    auto items = std::size_t{0};
+    for (auto [word, mask] : words) {
+      chunks.push_back({word, mask});
+      items += static_cast<std::size_t>(std::popcount(mask));
+    }
+    weight.push_back(items);
+  }
+  first.push_back(chunks.size());
+}
+
+/// Checks a single solution with freshly allocated scratch space.
+auto verifier::check(std::span<const std::size_t> solution) const -> bool {
+  auto covered = std::vector<std::uint64_t>((n_items + 63) / 64, 0);
+  return check(solution, covered);
+}
+
+/// Splits the solutions into contiguous ranges, one per thread, each thread
+/// reusing its own scratch bitset.
+auto verifier::check_all(std::span<const std::vector<std::size_t>> solutions,
+                         std::size_t n_threads) const
+    -> std::vector<std::size_t> {
+  n_threads = std::clamp(n_threads, std::size_t{1},
+                         std::max(solutions.size(), std::size_t{1}));
+  auto invalid = std::vector<std::vector<std::size_t>>(n_threads);
+  auto workers = std::vector<std::thread>{};
+  workers.reserve(n_threads);
+
+  for (std::size_t thread = 0; thread < n_threads; ++thread) {
+    workers.emplace_back([&, thread] {
+      auto covered = std::vector<std::uint64_t>((n_items + 63) / 64, 0);
+      auto begin = solutions.size() * thread / n_threads;
+      auto end = solutions.size() * (thread + 1) / n_threads;
+      for (auto position = begin; position < end; ++position)
+        if (!check(solutions[position], covered))
+          invalid[thread].push_back(position);
+    });
+  }
+  for (auto &worker : workers)
+    worker.join();
+
+  auto result = std::vector<std::size_t>{};
+  for (const auto &positions : invalid)
+    result.insert(result.end(), positions.begin(), positions.end());
+  return result;
+}
+
+/// Sets the bits of each option in turn, failing on the first bit already
+/// set. Without overlaps, all items are covered exactly when the number of
+/// bits set equals the number of items, so the bitset never has to be
+/// scanned as a whole. Only the words touched are cleared afterwards.
+auto verifier::check(std::span<const std::size_t> solution,
+                     std::vector<std::uint64_t> &covered) const -> bool {
+  auto valid = true;
+  auto total = std::size_t{0};
+  auto applied = std::size_t{0};
+  for (; applied < solution.size() && valid; ++applied) {
+    auto option = solution[applied];
+    if (option >= weight.size()) {
+      valid = false;
+      break;
+    }
+    for (auto chunk = first[option]; chunk != first[option + 1]; ++chunk) {
+      auto [word, mask] = chunks[chunk];
+      if (covered[word] & mask)
+        valid = false;
+      covered[word] |= mask;
+    }
+    total += weight[option];
+  }
+
+  for (std::size_t i = 0; i < applied; ++i) {
+    auto option = solution[i];
+    if (option >= weight.size())
+      break;
+    for (auto chunk = first[option]; chunk != first[option + 1]; ++chunk)
+      covered[chunks[chunk].word] = 0;
+  }
+  return valid && total == n_items;
+}
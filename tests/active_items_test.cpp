@@ -0,0 +1,85 @@
+//===-- active_items_test.cpp - Dense active item sizes test ----*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests the dense array of item sizes and the selection strategy using it.
+///
+//===----------------------------------------------------------------------===//
+
+#include "catch.hpp"
+
+#include "../include/active_items.h"
+#include "../include/dancing_links.h"
+#include "test_instances.h"
+
+using namespace dlx;
+using namespace dlx::test;
+
+TEST_CASE("Active items find the smallest size", "[active-items]") {
+  auto active = active_items{21};
+  for (std::uint32_t item = 0; item < 21; ++item)
+    active.resize(item, 100 - item);
+  REQUIRE(active.minimum() == 20);
+
+  active.resize(3, 7);
+  active.resize(17, 7);
+  REQUIRE(active.minimum() == 3);
+
+  active.remove(3);
+  REQUIRE(active.minimum() == 17);
+  active.remove(17);
+  REQUIRE(active.minimum() == 20);
+  active.resize(20, 1000);
+  REQUIRE(active.minimum() == 19);
+
+  active.restore(17);
+  REQUIRE(active.minimum() == 17);
+  active.restore(3);
+  active.resize(17, 8);
+  REQUIRE(active.minimum() == 3);
+}
+
+TEST_CASE("Active items can all be removed and restored", "[active-items]") {
+  auto active = active_items{10};
+  for (std::uint32_t item = 0; item < 10; ++item)
+    active.remove((item * 7) % 10);
+  REQUIRE(active.empty());
+  for (std::uint32_t item = 10; item-- > 0;)
+    active.restore((item * 7) % 10);
+  REQUIRE(!active.empty());
+  REQUIRE(active.minimum() < 10);
+}
+
+TEST_CASE("Dense selection finds the same solutions", "[active-items]") {
+  for (std::uint64_t seed = 0; seed < 100; ++seed) {
+    auto problem = random_instance(seed, 20);
+    auto linked = dancing_links{problem};
+    auto dense = dancing_links{problem};
+    dense.set_selection_strategy(selection_strategy::dense);
+    REQUIRE(sorted(dense.solve()) == sorted(linked.solve()));
+  }
+
+  auto problem = dancing_links{langford(8)};
+  problem.set_selection_strategy(selection_strategy::dense);
+  REQUIRE(problem.count() == 300);
+  problem.set_selection_strategy(selection_strategy::linked);
+  REQUIRE(problem.count() == 300);
+}
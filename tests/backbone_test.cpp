@@ -0,0 +1,83 @@
+//===-- backbone_test.cpp - Backbone computation test -----------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests the computation of which options belong to some, and which to all
+/// exact covers.
+///
+//===----------------------------------------------------------------------===//
+
+#include "catch.hpp"
+
+#include "../include/backbone.h"
+#include "../include/dancing_links.h"
+#include "test_instances.h"
+
+using namespace dlx;
+using namespace dlx::test;
+
+namespace {
+/// Backbone computed from all exact covers.
+auto enumerated_backbone(const instance &problem) -> backbone {
+  auto solutions = dancing_links{problem}.solve();
+  auto result = backbone{};
+  auto occurrences = std::vector<std::size_t>(problem.options.size(), 0);
+  for (const auto &solution : solutions)
+    for (auto option : solution)
+      ++occurrences[option];
+  for (auto count : occurrences) {
+    result.in_some.push_back(count != 0);
+    result.in_all.push_back(count != 0 && count == solutions.size());
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("Backbone matches enumeration of all exact covers", "[backbone]") {
+  auto problems = std::vector<instance>{langford(7), langford(5)};
+  for (std::uint64_t seed = 0; seed < 30; ++seed)
+    problems.push_back(random_instance(seed));
+
+  for (const auto &problem : problems) {
+    auto expected = enumerated_backbone(problem);
+    for (std::size_t threads : {1, 3}) {
+      auto result = compute_backbone(problem, threads);
+      REQUIRE(result.in_some == expected.in_some);
+      REQUIRE(result.in_all == expected.in_all);
+    }
+  }
+}
+
+TEST_CASE("Backbone finds forced options", "[backbone]") {
+  // Options 0 and 1 are forced; 2 and 3 are interchangeable with 4 and 5;
+  // option 6 conflicts with the forced ones.
+  auto problem = instance{6, {{0}, {1}, {2, 3}, {4, 5}, {2, 4}, {3, 5},
+                              {0, 1, 2}}};
+  auto result = compute_backbone(problem, 2);
+  REQUIRE(result.in_some ==
+          std::vector<bool>{true, true, true, true, true, true, false});
+  REQUIRE(result.in_all ==
+          std::vector<bool>{true, true, false, false, false, false, false});
+
+  // Exact covers found for one option witness the others, so that fewer
+  // searches are needed than there are options.
+  REQUIRE(result.searches < problem.options.size());
+}
@@ -0,0 +1,112 @@
+//===-- batch_solver_test.cpp - Batch solving test --------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests the thread pool solving streams of independent exact cover problems.
+///
+//===----------------------------------------------------------------------===//
+
+#include "catch.hpp"
+
+#include "../include/batch_solver.h"
+#include "../include/dancing_links.h"
+#include "test_instances.h"
+
+using namespace dlx;
+using namespace dlx::test;
+
+TEST_CASE("Batch solver solves submitted instances", "[batch]") {
+  auto solver = batch_solver{3};
+  auto results = std::vector<std::future<batch_result>>{};
+  for (std::size_t n = 3; n <= 7; ++n)
+    results.push_back(solver.submit(langford(n), solve_mode::count));
+
+  auto expected = std::vector<std::size_t>{2, 2, 0, 0, 52};
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    auto result = results[i].get();
+    REQUIRE(result.count == expected[i]);
+    REQUIRE(result.solutions.empty());
+  }
+}
+
+TEST_CASE("Batch solver reports solutions according to mode", "[batch]") {
+  auto solver = batch_solver{2};
+  auto all = solver.submit(langford(7), solve_mode::all);
+  auto first = solver.submit(langford(7), solve_mode::first);
+  auto none = solver.submit(langford(5), solve_mode::first);
+
+  REQUIRE(sorted(all.get().solutions) ==
+          sorted(dancing_links(langford(7)).solve()));
+
+  auto result = first.get();
+  REQUIRE(result.count == 1);
+  REQUIRE(result.solutions.size() == 1);
+  REQUIRE(none.get().count == 0);
+}
+
+TEST_CASE("Batch solver keeps a limited number of solutions", "[batch]") {
+  auto solver = batch_solver{1};
+  auto result = solver.submit(langford(7), solve_mode::all, 3).get();
+  REQUIRE(result.count == 52);
+  REQUIRE(result.solutions.size() == 3);
+  auto none = solver.submit(langford(7), solve_mode::all, 0).get();
+  REQUIRE(none.count == 52);
+  REQUIRE(none.solutions.empty());
+}
+
+TEST_CASE("Batch solver reports latency percentiles", "[batch]") {
+  auto solver = batch_solver{2};
+  REQUIRE(solver.latencies().samples == 0);
+
+  auto results = std::vector<std::future<batch_result>>{};
+  for (std::size_t i = 0; i < 100; ++i)
+    results.push_back(solver.submit(langford(3 + i % 5), solve_mode::count));
+  for (auto &result : results)
+    REQUIRE(result.get().latency.count() > 0);
+
+  auto summary = solver.latencies();
+  REQUIRE(summary.samples == 100);
+  REQUIRE(summary.p50 <= summary.p90);
+  REQUIRE(summary.p90 <= summary.p99);
+  REQUIRE(summary.p99 <= summary.max);
+}
+
+TEST_CASE("Batch solver finishes queued instances on destruction",
+          "[batch]") {
+  auto results = std::vector<std::future<batch_result>>{};
+  {
+    auto solver = batch_solver{1};
+    for (std::size_t i = 0; i < 10; ++i)
+      results.push_back(solver.submit(langford(4)));
+  }
+  for (auto &result : results)
+    REQUIRE(result.get().count == 2);
+}
+
+TEST_CASE("Batch solver handles instances exceeding its arena", "[batch]") {
+  auto problem = instance{5000};
+  for (std::size_t item = 0; item < problem.items; ++item)
+    problem.options.push_back({item});
+
+  auto solver = batch_solver{1};
+  REQUIRE(solver.submit(problem, solve_mode::count).get().count == 1);
+  REQUIRE(solver.submit(problem, solve_mode::first).get().count == 1);
+}
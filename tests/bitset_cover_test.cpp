@@ -0,0 +1,96 @@
+//===-- bitset_cover_test.cpp - Bitset exact cover test ---------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests the word-parallel search and the hybrid mode of the linked engine.
+///
+//===----------------------------------------------------------------------===//
+
+#include "catch.hpp"
+
+#include "../include/bitset_cover.h"
+#include "../include/dancing_links.h"
+#include "../include/trail_dancing_links.h"
+#include "test_instances.h"
+
+using namespace dlx;
+using namespace dlx::test;
+
+TEST_CASE("Bitset search finds all exact covers", "[bitset]") {
+  auto problem = bitset_cover{};
+  problem.reset(4);
+  problem.add_option(0b0011, 10);
+  problem.add_option(0b1100, 11);
+  problem.add_option(0b0101, 12);
+  problem.add_option(0b1010, 13);
+  problem.add_option(0b0110, 14);
+
+  auto selection = std::vector<std::size_t>{};
+  auto solutions = std::vector<std::vector<std::size_t>>{};
+  auto stopped = problem.search(problem.all_items(), selection, [&] {
+    solutions.push_back(selection);
+    return false;
+  });
+  REQUIRE(!stopped);
+  REQUIRE(selection.empty());
+  REQUIRE(sorted(solutions) ==
+          std::vector<std::vector<std::size_t>>{{10, 11}, {12, 13}});
+
+  REQUIRE(problem.search(problem.all_items(), selection, [] { return true; }));
+  REQUIRE(selection.size() == 2);
+}
+
+TEST_CASE("Bitset search handles 64 items", "[bitset]") {
+  auto problem = bitset_cover{};
+  problem.reset(64);
+  REQUIRE(problem.all_items() == ~std::uint64_t{0});
+  problem.add_option(~std::uint64_t{0} >> 32, 0);
+  problem.add_option(~std::uint64_t{0} << 32, 1);
+
+  auto selection = std::vector<std::size_t>{};
+  auto count = std::size_t{0};
+  problem.search(problem.all_items(), selection, [&] {
+    ++count;
+    return false;
+  });
+  REQUIRE(count == 1);
+}
+
+TEST_CASE("Hybrid search finds the same solutions", "[bitset]") {
+  for (std::uint64_t seed = 0; seed < 100; ++seed) {
+    // Forced items push the matrix beyond the bitset limit at first.
+    auto problem = random_instance(seed, 16);
+    for (std::size_t forced = 0; forced < 60; ++forced)
+      problem.options.push_back({problem.items++});
+    auto expected = sorted(trail_dancing_links(problem).solve());
+    for (std::size_t threshold : {1, 8, 1000}) {
+      auto hybrid = dancing_links{problem};
+      hybrid.set_bitset_threshold(threshold);
+      REQUIRE(sorted(hybrid.solve()) == expected);
+      REQUIRE(hybrid.quicksolve().empty() == expected.empty());
+      REQUIRE(hybrid.selection().empty());
+    }
+  }
+
+  auto langford_problem = dancing_links{langford(8)};
+  langford_problem.set_bitset_threshold(100);
+  REQUIRE(langford_problem.count() == 300);
+}
@@ -0,0 +1,171 @@
+//===-- cnf_test.cpp - CNF export test --------------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests the conversion between exact cover problems and DIMACS CNF.
+///
+//===----------------------------------------------------------------------===//
+
+#include "catch.hpp"
+
+#include "../include/cnf.h"
+#include "test_instances.h"
+
+#include <cstdlib>
+#include <sstream>
+
+using namespace dlx;
+using namespace dlx::test;
+
+namespace {
+struct formula {
+  std::size_t variables = 0;
+  std::vector<std::vector<long long>> clauses = {};
+};
+
+auto parse(std::istream &stream) -> formula {
+  auto result = formula{};
+  auto header = std::string{};
+  auto clauses = std::size_t{0};
+  stream >> header >> header >> result.variables >> clauses;
+  auto literal = 0ll;
+  result.clauses.emplace_back();
+  while (stream >> literal) {
+    if (literal == 0)
+      result.clauses.emplace_back();
+    else
+      result.clauses.back().push_back(literal);
+  }
+  result.clauses.pop_back();
+  REQUIRE(result.clauses.size() == clauses);
+  return result;
+}
+
+/// Minimal backtracking satisfiability check, extending a partial
+/// assignment (0 unassigned, 1 true, -1 false) in variable order.
+auto satisfiable(const formula &cnf, std::vector<int> &assignment,
+                 std::size_t variable) -> bool {
+  for (const auto &clause : cnf.clauses) {
+    auto open = false;
+    for (auto literal : clause) {
+      auto value = assignment[std::llabs(literal)];
+      if (value == 0 || (value > 0) == (literal > 0))
+        open = true;
+    }
+    if (!open)
+      return false;
+  }
+  if (variable > cnf.variables)
+    return true;
+  for (auto value : {1, -1}) {
+    assignment[variable] = value;
+    if (satisfiable(cnf, assignment, variable + 1))
+      return true;
+  }
+  assignment[variable] = 0;
+  return false;
+}
+
+/// Counts assignments to the option variables that extend to a model.
+auto count_models(const formula &cnf, std::size_t n_options) -> std::size_t {
+  auto total = std::size_t{0};
+  for (std::size_t mask = 0; mask < (std::size_t{1} << n_options); ++mask) {
+    auto assignment = std::vector<int>(cnf.variables + 1, 0);
+    for (std::size_t option = 0; option < n_options; ++option)
+      assignment[option + 1] = (mask >> option) & 1 ? 1 : -1;
+    total += satisfiable(cnf, assignment, n_options + 1);
+  }
+  return total;
+}
+} // namespace
+
+TEST_CASE("CNF models correspond to exact covers", "[cnf]") {
+  auto problem = instance{5, {{0, 1}, {2}, {0}, {1, 2}, {3, 4}, {3}, {4}}};
+  auto expected = dancing_links(problem).count();
+
+  for (std::size_t limit : {0, 1, 4}) {
+    auto matrix = dancing_links(problem);
+    auto stream = std::stringstream{};
+    write_cnf(stream, matrix, {limit});
+    auto cnf = parse(stream);
+    REQUIRE(count_models(cnf, problem.options.size()) == expected);
+  }
+}
+
+TEST_CASE("CNF encodes uncoverable items as empty clauses", "[cnf]") {
+  auto matrix = dancing_links(3, {{0}, {1}});
+  auto stream = std::stringstream{};
+  write_cnf(stream, matrix);
+  REQUIRE(count_models(parse(stream), 2) == 0);
+}
+
+TEST_CASE("CNF size is linear with sequential counters", "[cnf]") {
+  auto problem = instance{1};
+  for (std::size_t option = 0; option < 100; ++option)
+    problem.options.push_back({0});
+
+  auto matrix = dancing_links(problem);
+  auto stream = std::stringstream{};
+  write_cnf(stream, matrix);
+  auto cnf = parse(stream);
+  REQUIRE(cnf.variables == 100 + 99);
+  REQUIRE(cnf.clauses.size() == 1 + 3 * 100 - 4);
+}
+
+TEST_CASE("SAT models map back to options", "[cnf]") {
+  auto competition = std::stringstream{
+      "c comment\ns SATISFIABLE\nv 1 -2 3\nv -4 5 12 0\n"};
+  REQUIRE(read_sat_model(competition, 5) ==
+          std::vector<std::size_t>{0, 2, 4});
+
+  auto minisat = std::stringstream{"SAT\n-1 2 -3 0\n"};
+  REQUIRE(read_sat_model(minisat, 3) == std::vector<std::size_t>{1});
+
+  auto unsat = std::stringstream{"s UNSATISFIABLE\n"};
+  REQUIRE(!read_sat_model(unsat, 3));
+  auto garbage = std::stringstream{"v 1 x 0\n"};
+  REQUIRE(!read_sat_model(garbage, 3));
+}
+
+TEST_CASE("SAT models of Langford pairs are exact covers", "[cnf]") {
+  auto problem = langford(3);
+  auto matrix = dancing_links(problem);
+  auto stream = std::stringstream{};
+  write_cnf(stream, matrix);
+  auto cnf = parse(stream);
+
+  auto solutions = std::vector<std::vector<std::size_t>>{};
+  auto n_options = problem.options.size();
+  for (std::size_t mask = 0; mask < (std::size_t{1} << n_options); ++mask) {
+    auto assignment = std::vector<int>(cnf.variables + 1, 0);
+    auto model = std::string{"v"};
+    for (std::size_t option = 0; option < n_options; ++option) {
+      auto value = (mask >> option) & 1 ? 1 : -1;
+      assignment[option + 1] = value;
+      model += ' ' + std::to_string(value * static_cast<int>(option + 1));
+    }
+    if (satisfiable(cnf, assignment, n_options + 1)) {
+      auto output = std::stringstream{"s SATISFIABLE\n" + model + " 0\n"};
+      solutions.push_back(*read_sat_model(output, n_options));
+    }
+  }
+  REQUIRE(sorted(solutions) == sorted(matrix.solve()));
+}
@@ -0,0 +1,309 @@
+//===-- dancing_links_benchmark.cpp - Dancing links benchmarks --*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Micro-benchmarks of the search primitives and full solves.
+///
+//===----------------------------------------------------------------------===//
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+// Catch's alternate signal stack does not compile against glibc 2.34+.
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
+#include "catch.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "../include/backbone.h"
+#include "../include/dancing_links.h"
+#include "../include/infeasible_core.h"
+#include "../include/instance_io.h"
+#include "../include/memory_placement.h"
+#include "test_instances.h"
+
+using namespace dlx;
+using namespace dlx::test;
+
+namespace {
+/// Problem with 4 options per item, each containing an item with the given
+/// probability. Every item is contained in at least one option.
+auto random_dense(std::size_t items, double density) -> instance {
+  auto random = std::mt19937_64{items};
+  auto contains = std::bernoulli_distribution{density};
+  auto problem = instance{items};
+  problem.options.resize(4 * items);
+  for (std::size_t option = 0; option < problem.options.size(); ++option) {
+    for (std::size_t item = 0; item < items; ++item) {
+      if (item == option % items || contains(random))
+        problem.options[option].push_back(item);
+    }
+  }
+  return problem;
+}
+
+/// Problem with 4 options per item, each containing that item and
+/// <width> - 1 others at random, large enough not to fit in cache.
+auto random_sparse(std::size_t items, std::size_t width) -> instance {
+  auto random = std::mt19937_64{items};
+  auto pick = std::uniform_int_distribution<std::size_t>{0, items - 1};
+  auto problem = instance{items};
+  problem.options.resize(4 * items);
+  for (std::size_t option = 0; option < problem.options.size(); ++option) {
+    auto &set = problem.options[option];
+    set.push_back(option % items);
+    while (set.size() < width) {
+      auto item = pick(random);
+      if (std::find(set.begin(), set.end(), item) == set.end())
+        set.push_back(item);
+    }
+  }
+  return problem;
+}
+
+auto label(std::string name, std::size_t items, double density) {
+  return name + " (" + std::to_string(items) + " items, " +
+         std::to_string(static_cast<int>(density * 100)) + "% density)";
+}
+} // namespace
+
+TEST_CASE("Search primitives", "[benchmark]") {
+  auto items = GENERATE(as<std::size_t>{}, 32, 128, 512);
+  auto density = GENERATE(0.05, 0.2);
+  auto problem = dancing_links{random_dense(items, density)};
+  auto &first = *problem.column(0).begin();
+  auto &top = first.parent_item();
+  auto &option = first.parent_option();
+
+  BENCHMARK(label("item::cover/uncover", items, density)) {
+    top.cover();
+    top.uncover();
+    return top.count();
+  };
+
+  BENCHMARK(label("option::hide/unhide", items, density)) {
+    option.hide(first);
+    option.unhide(first);
+    return option.size();
+  };
+
+  BENCHMARK(label("option::cover/uncover", items, density)) {
+    option.cover();
+    option.uncover();
+    return option.size();
+  };
+
+  BENCHMARK(label("next candidate", items, density)) {
+    return problem.candidates();
+  };
+}
+
+TEST_CASE("Full solves of Langford pairs", "[benchmark]") {
+  auto order = GENERATE(as<std::size_t>{}, 7, 8);
+  auto langford_problem = langford(order);
+  BENCHMARK("Langford pairs, order " + std::to_string(order)) {
+    return dancing_links{langford_problem}.count();
+  };
+}
+
+TEST_CASE("Full solves of random problems", "[benchmark]") {
+  auto items = GENERATE(as<std::size_t>{}, 24, 48);
+  auto dense = random_dense(items, 0.1);
+  BENCHMARK(label("random count", items, 0.1)) {
+    return dancing_links{dense}.count();
+  };
+}
+
+TEST_CASE("Selection strategies", "[benchmark]") {
+  auto items = GENERATE(as<std::size_t>{}, 128, 1024);
+  auto problem = dancing_links{random_dense(items, 0.01)};
+  BENCHMARK(label("linked selection", items, 0.01)) {
+    return problem.candidates();
+  };
+
+  problem.set_selection_strategy(selection_strategy::dense);
+  BENCHMARK(label("dense selection", items, 0.01)) {
+    return problem.candidates();
+  };
+}
+
+TEST_CASE("Uniform option widths", "[benchmark]") {
+  auto order = GENERATE(as<std::size_t>{}, 8, 9);
+  auto uniform = langford(order);
+  BENCHMARK("unrolled width 3, Langford order " + std::to_string(order)) {
+    return dancing_links{uniform}.count();
+  };
+
+  // A single option of a different width disables the unrolled loops.
+  auto mixed = uniform;
+  mixed.options.push_back({mixed.items++});
+  BENCHMARK("runtime width, Langford order " + std::to_string(order)) {
+    return dancing_links{mixed}.count();
+  };
+}
+
+TEST_CASE("Hybrid bitset search", "[benchmark]") {
+  auto threshold = GENERATE(as<std::size_t>{}, 0, 16, 64);
+  auto problem = langford(9);
+  BENCHMARK("Langford order 9, bitset threshold " +
+            std::to_string(threshold)) {
+    auto solver = dancing_links{problem};
+    solver.set_bitset_threshold(threshold);
+    return solver.count();
+  };
+}
+
+TEST_CASE("Parsing text", "[benchmark]") {
+  auto stream = std::ostringstream{};
+  write_instance(stream, random_dense(512, 0.05));
+  auto text = stream.str();
+  auto options = text.substr(text.find('\n') + 1);
+  for (std::size_t copy = 0; copy < 15; ++copy)
+    text += options;
+
+  auto threads = GENERATE(1, 2, 4, 8);
+  BENCHMARK("Parse " + std::to_string(text.size() >> 20) + " MiB on " +
+            std::to_string(threads) + " threads") {
+    return parse_instance(text, threads);
+  };
+}
+
+TEST_CASE("Matrix construction", "[benchmark]") {
+  auto problem = random_dense(2048, 0.05);
+  auto threads = GENERATE(1, 2, 4);
+  BENCHMARK("Build 2048 items on " + std::to_string(threads) + " threads") {
+    return dancing_links{problem, static_cast<std::size_t>(threads)}
+        .uniform_width();
+  };
+}
+
+TEST_CASE("Huge page arena", "[benchmark]") {
+  auto problem = langford(10);
+  BENCHMARK("Langford 10 on the heap") {
+    return dancing_links{problem}.count();
+  };
+  BENCHMARK("Langford 10 in a huge page arena") {
+    auto arena = huge_page_resource{};
+    return dancing_links{problem, &arena}.count();
+  };
+}
+
+TEST_CASE("Covering in large sparse problems", "[benchmark]") {
+  // Build with DLX_PREFETCH to compare against prefetching. Items are
+  // covered in random order, so that their columns are not in cache.
+  auto items = GENERATE(as<std::size_t>{}, 1 << 12, 1 << 16);
+  auto problem = dancing_links{random_sparse(items, 8)};
+  auto indices = std::vector<std::size_t>(items);
+  std::iota(indices.begin(), indices.end(), std::size_t{0});
+  std::shuffle(indices.begin(), indices.end(), std::mt19937_64{items});
+  auto order = std::vector<item *>{};
+  for (auto index : std::span{indices}.first(256))
+    order.push_back(&(*problem.column(index).begin()).parent_item());
+
+  BENCHMARK("Cover and uncover 256 items of " + std::to_string(items)) {
+    auto total = std::size_t{0};
+    for (auto *column : order) {
+      column->cover();
+      total += column->count();
+    }
+    for (auto column = order.rbegin(); column != order.rend(); ++column)
+      (*column)->uncover();
+    return total;
+  };
+}
+
+TEST_CASE("Backbone", "[benchmark]") {
+  auto problem = langford(11);
+  BENCHMARK("Backbone of Langford pairs, order 11, by enumeration") {
+    return dancing_links{problem}.solve().size();
+  };
+  BENCHMARK("Backbone of Langford pairs, order 11, by witnesses") {
+    return compute_backbone(problem, 1).searches;
+  };
+}
+
+TEST_CASE("Infeasible core", "[benchmark]") {
+  // Langford pairs of order 11 with an odd cycle of pairs added.
+  auto problem = langford(11);
+  auto first = problem.items;
+  problem.items += 3;
+  problem.options.push_back({first, first + 1});
+  problem.options.push_back({first + 1, first + 2});
+  problem.options.push_back({first, first + 2});
+
+  BENCHMARK("Infeasible core of Langford pairs with an odd cycle") {
+    return find_infeasible_core(problem)->searches;
+  };
+}
+
+TEST_CASE("Domino tilings", "[benchmark]") {
+  for (auto matching : {false, true}) {
+    auto method = std::string{matching ? "matchings" : "search"};
+    BENCHMARK("Count domino tilings of a 6x6 board by " + method) {
+      auto problem = dancing_links{domino(6, 6)};
+      problem.set_matching(matching);
+      return problem.count();
+    };
+    // Two opposite corners removed: no tiling, but every row can be filled.
+    auto board = domino(8, 8);
+    board.items -= 1;
+    std::erase_if(board.options, [&](const auto &option) {
+      return option[0] == 0 || option[1] == board.items;
+    });
+    for (auto &option : board.options)
+      for (auto &item : option)
+        --item;
+    board.items -= 1;
+    BENCHMARK("Tile a mutilated 8x8 board by " + method) {
+      auto problem = dancing_links{board};
+      problem.set_matching(matching);
+      return problem.quicksolve().size();
+    };
+  }
+}
+
+TEST_CASE("Strip tilings", "[benchmark]") {
+  auto shapes = std::vector<std::vector<cell>>{
+      {{0, 0}, {0, 1}},         {{0, 0}, {1, 0}},
+      {{0, 0}, {1, 0}, {1, 1}}, {{0, 0}, {0, 1}, {1, 0}},
+      {{0, 0}, {0, 1}, {1, 1}}, {{0, 1}, {1, 0}, {1, 1}}};
+  for (std::size_t length : {6, 12, 24}) {
+    auto board = tiling(4, length, shapes);
+    auto size = "4x" + std::to_string(length);
+    if (length <= 6) {
+      BENCHMARK("Count tilings of " + size + " by search") {
+        auto problem = dancing_links{board};
+        problem.set_sweeping(false);
+        return problem.count();
+      };
+    }
+    BENCHMARK("Count tilings of " + size + " by sweeping") {
+      return dancing_links{board}.count();
+    };
+  }
+  auto tall = tiling(24, 4, shapes);
+  BENCHMARK("Count tilings of 24x4 by sweeping") {
+    return dancing_links{tall}.count();
+  };
+}
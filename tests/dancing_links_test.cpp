@@ -25,13 +25,19 @@
 //===----------------------------------------------------------------------===//
 
 #define CATCH_CONFIG_MAIN
+// Catch's alternate signal stack does not compile against glibc 2.34+.
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
 #include "catch.hpp"
 
 #include "../include/dancing_links.h"
+#include "test_instances.h"
 
 #include <algorithm>
+#include <atomic>
+#include <memory_resource>
 
 using namespace dlx;
+using namespace dlx::test;
 
 TEST_CASE("Catch works", "[catch]") {
   REQUIRE(true == true);
@@ -72,6 +78,27 @@ TEST_CASE("A node can remove itself reversibly from a linked list", "[node]") {
   REQUIRE(list.size() == 2);
 }
 
+TEST_CASE("An item can remove itself reversibly from a linked list",
+          "[item]") {
+  linked_list<item> list{3};
+  list[1].remove();
+  REQUIRE(list.size() == 2);
+  REQUIRE(&list[0].next() == &list[2]);
+  REQUIRE(&list[2].previous() == &list[0]);
+
+  list[1].reinsert();
+  REQUIRE(list.size() == 3);
+  REQUIRE(&list[0].next() == &list[1]);
+  REQUIRE(&list[2].previous() == &list[1]);
+}
+
+TEST_CASE("A linked list can be constructed without elements",
+          "[linked_list]") {
+  linked_list<item> list{0};
+  REQUIRE(list.empty());
+  REQUIRE(list.size() == 0);
+}
+
 TEST_CASE("Dancing links solver correctly identifies solutions",
     "[dancing-links]") {
   auto problem = dancing_links(4, {{1, 2}, {0}, {0, 3}, {3}});
@@ -104,4 +131,118 @@ TEST_CASE("Dancing links solver can handle empty option sets",
   auto solutions = problem.solve();
 
   REQUIRE(solutions.empty());
-}
\ No newline at end of file
+}
+
+TEST_CASE("Dancing links matrix can be built in an arena", "[dancing-links]") {
+  auto buffer = std::vector<std::byte>(1 << 16);
+  auto arena = std::pmr::monotonic_buffer_resource{
+      buffer.data(), buffer.size(), std::pmr::null_memory_resource()};
+  auto problem = dancing_links(
+      4, std::vector<std::vector<std::size_t>>{{1, 2}, {0}, {0, 3}, {3}},
+      &arena);
+
+  REQUIRE(problem.count() == 2);
+  REQUIRE(problem.solve().size() == 2);
+}
+
+TEST_CASE("Dancing links lookahead prunes without losing solutions",
+          "[dancing-links]") {
+  auto problem = dancing_links(5, {{0, 1}, {0, 2}, {1, 2}, {3, 4}});
+  problem.set_lookahead({false, true});
+
+  REQUIRE(problem.solve().empty());
+  REQUIRE(problem.pruned_options() == 2);
+}
+
+TEST_CASE("Lookahead at selected depths preserves all solutions",
+          "[dancing-links]") {
+  auto expected = sorted(dancing_links(langford(8)).solve());
+  for (auto depths : {std::vector<bool>{true}, std::vector<bool>{false, true},
+                      std::vector<bool>(24, true)}) {
+    auto problem = dancing_links(langford(8));
+    problem.set_lookahead(depths);
+    REQUIRE(sorted(problem.solve()) == expected);
+    REQUIRE(problem.quicksolve().size() == 8);
+  }
+
+  auto problem = dancing_links(langford(8));
+  problem.set_lookahead(std::vector<bool>(24, true));
+  problem.count();
+  REQUIRE(problem.pruned_options() > 0);
+}
+
+TEST_CASE("Uniform option widths use unrolled loops", "[dancing-links]") {
+  auto problem = langford(8);
+  auto uniform = dancing_links{problem};
+  REQUIRE(uniform.uniform_width() == 3);
+  REQUIRE(uniform.count() == 300);
+
+  // An extra item with a single option of its own leaves the solutions
+  // unchanged, but makes the widths differ.
+  problem.options.push_back({problem.items++});
+  auto mixed = dancing_links{problem};
+  REQUIRE(mixed.uniform_width() == 0);
+  REQUIRE(sorted(mixed.solve()).size() == 300);
+
+  auto pairs = dancing_links{4, {{0, 1}, {2, 3}, {0, 2}, {1, 3}, {0, 3}}};
+  REQUIRE(pairs.uniform_width() == 2);
+  REQUIRE(sorted(pairs.solve()) ==
+          std::vector<std::vector<std::size_t>>{{0, 1}, {2, 3}});
+  REQUIRE(pairs.quicksolve().size() == 2);
+}
+
+TEST_CASE("Columns linked on several threads match serial construction",
+          "[dancing-links]") {
+  auto column_options = [](dancing_links &matrix, std::size_t items) {
+    auto columns = std::vector<std::vector<std::size_t>>(items);
+    for (std::size_t item = 0; item < items; ++item)
+      for (auto &node : matrix.column(item))
+        columns[item].push_back(node.parent_option().get_index());
+    return columns;
+  };
+
+  for (auto problem : {langford(8), random_instance(1), random_instance(2),
+                       instance{5, {{0, 1}}}, instance{3, {}}}) {
+    auto serial = dancing_links{problem, 1};
+    auto expected = column_options(serial, problem.items);
+    auto solutions = sorted(serial.solve());
+    for (std::size_t threads : {2, 3, 16}) {
+      auto parallel = dancing_links{problem, threads};
+      REQUIRE(column_options(parallel, problem.items) == expected);
+      REQUIRE(sorted(parallel.solve()) == solutions);
+    }
+  }
+}
+
+TEST_CASE("Searches stop once their budget is spent", "[dancing-links]") {
+  auto limited = dancing_links{langford(8)};
+  limited.set_budget({100});
+  REQUIRE(limited.count() < 300);
+  REQUIRE(limited.stopped());
+  REQUIRE(limited.quicksolve().empty());
+
+  auto cancelled = std::atomic<bool>{true};
+  auto budget = search_budget{};
+  budget.cancelled = &cancelled;
+  limited.set_budget(budget);
+  REQUIRE(!limited.stopped());
+  limited.count();
+  REQUIRE(limited.stopped());
+
+  // Unfinished subtrees are not learned as nogoods.
+  auto store = nogood_store{1 << 12};
+  auto learning = dancing_links{langford(8)};
+  learning.set_nogood_store(&store);
+  learning.set_budget({50});
+  learning.count();
+  learning.set_budget({});
+  REQUIRE(learning.count() == 300);
+  REQUIRE(!learning.stopped());
+
+  auto swept = dancing_links{tiling(6, 6, {{{0, 0}, {0, 1}, {0, 2}},
+                                           {{0, 0}, {1, 0}, {2, 0}}})};
+  swept.set_budget({10});
+  swept.count();
+  REQUIRE(swept.stopped());
+}
+
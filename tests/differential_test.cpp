@@ -0,0 +1,325 @@
+//===-- differential_test.cpp - Differential test ---------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Runs every engine on the same random problems and compares their results.
+///
+//===----------------------------------------------------------------------===//
+
+#include "catch.hpp"
+
+#include <functional>
+#include <sstream>
+
+#include "../include/batch_solver.h"
+#include "../include/dancing_links.h"
+#include "../include/instance_io.h"
+#include "../include/nogood_store.h"
+#include "../include/parallel_dancing_links.h"
+#include "../include/trail_dancing_links.h"
+#include "../include/verifier.h"
+#include "test_instances.h"
+
+#if defined(DLX_POSIX)
+#include "../include/distributed_search.h"
+#endif
+
+using namespace dlx;
+using namespace dlx::test;
+
+namespace {
+/// Plain backtracking over a coverage vector, sharing no code with any of
+/// the engines, as the reference all engines are compared against.
+void reference(const instance &problem, std::vector<bool> &covered,
+               std::vector<std::size_t> &selection,
+               std::vector<std::vector<std::size_t>> &solutions) {
+  auto item = std::find(covered.begin(), covered.end(), false);
+  if (item == covered.end()) {
+    solutions.push_back(selection);
+    return;
+  }
+  auto target = static_cast<std::size_t>(item - covered.begin());
+  for (std::size_t option = 0; option < problem.options.size(); ++option) {
+    const auto &items = problem.options[option];
+    if (std::find(items.begin(), items.end(), target) == items.end() ||
+        std::any_of(items.begin(), items.end(),
+                    [&](auto other) { return covered[other]; }))
+      continue;
+    for (auto other : items)
+      covered[other] = true;
+    selection.push_back(option);
+    reference(problem, covered, selection, solutions);
+    selection.pop_back();
+    for (auto other : items)
+      covered[other] = false;
+  }
+}
+
+auto reference(const instance &problem) {
+  auto covered = std::vector<bool>(problem.items, false);
+  auto selection = std::vector<std::size_t>{};
+  auto solutions = std::vector<std::vector<std::size_t>>{};
+  reference(problem, covered, selection, solutions);
+  return sorted(solutions);
+}
+
+/// Checks the exact covers found below every selection of up to <depth>
+/// candidates against those of <expected> containing the selection.
+void check_prefixes(dancing_links &matrix,
+                    const std::vector<std::vector<std::size_t>> &expected,
+                    std::size_t depth) {
+  auto found = std::vector<std::vector<std::size_t>>{};
+  matrix.enumerate([&](auto subset) {
+    found.emplace_back(subset.begin(), subset.end());
+  });
+  auto extending = std::vector<std::vector<std::size_t>>{};
+  for (const auto &solution : expected) {
+    auto selection = matrix.selection();
+    if (std::all_of(selection.begin(), selection.end(), [&](auto option) {
+          return std::find(solution.begin(), solution.end(), option) !=
+                 solution.end();
+        }))
+      extending.push_back(solution);
+  }
+  REQUIRE(sorted(found) == extending);
+
+  if (depth == 0)
+    return;
+  for (auto option : matrix.candidates()) {
+    matrix.select(option);
+    check_prefixes(matrix, expected, depth - 1);
+    matrix.deselect();
+  }
+}
+} // namespace
+
+TEST_CASE("All engines agree on random problems", "[differential]") {
+  auto batch = batch_solver{2};
+  for (std::uint64_t seed = 0; seed < 300; ++seed) {
+    CAPTURE(seed);
+    auto problem = random_instance(seed);
+    auto expected = reference(problem);
+    auto check = verifier{problem};
+
+    REQUIRE(sorted(dancing_links(problem).solve()) == expected);
+    REQUIRE(dancing_links(problem).count() == expected.size());
+    REQUIRE(sorted(parallel_dancing_links(problem, 3).solve()) == expected);
+    REQUIRE(parallel_dancing_links(problem, 3).count() == expected.size());
+    REQUIRE(sorted(trail_dancing_links(problem).solve()) == expected);
+    REQUIRE(trail_dancing_links(problem).count() == expected.size());
+
+    auto all = batch.submit(problem, solve_mode::all).get();
+    REQUIRE(sorted(all.solutions) == expected);
+    REQUIRE(batch.submit(problem, solve_mode::count).get().count ==
+            expected.size());
+
+    auto first = dancing_links(problem).quicksolve();
+    auto trail_first = trail_dancing_links(problem).quicksolve();
+    REQUIRE(first.empty() == expected.empty());
+    REQUIRE(trail_first.empty() == expected.empty());
+    if (!expected.empty()) {
+      REQUIRE(check.check(first));
+      REQUIRE(check.check(trail_first));
+    }
+  }
+}
+
+TEST_CASE("Search configurations agree on random problems",
+          "[differential]") {
+  // Each configuration is applied to fresh matrices, then used to find all
+  // exact covers, count them, and find one. Matrices for the same problem
+  // share their nogood store.
+  auto store = nogood_store{1 << 10};
+  auto configurations = std::vector<std::function<void(dancing_links &)>>{
+      [](auto &matrix) {
+        matrix.set_selection_strategy(selection_strategy::dense);
+      },
+      [](auto &matrix) { matrix.set_bitset_threshold(4); },
+      [](auto &matrix) { matrix.set_bitset_threshold(1 << 20); },
+      [](auto &matrix) {
+        matrix.set_selection_strategy(selection_strategy::dense);
+        matrix.set_bitset_threshold(6);
+      },
+      [](auto &matrix) {
+        matrix.set_lookahead(std::vector<bool>(16, true));
+      },
+      [](auto &matrix) {
+        matrix.set_selection_strategy(selection_strategy::dense);
+        matrix.set_lookahead({false, true, false, true});
+      },
+      [&](auto &matrix) { matrix.set_nogood_store(&store); },
+  };
+
+  for (std::uint64_t seed = 0; seed < 300; ++seed) {
+    CAPTURE(seed);
+    auto problem = random_instance(seed);
+    auto expected = reference(problem);
+    auto check = verifier{problem};
+    store = nogood_store{1 << 10};
+
+    for (std::size_t index = 0; index < configurations.size(); ++index) {
+      CAPTURE(index);
+      const auto &configure = configurations[index];
+      auto all = dancing_links(problem);
+      configure(all);
+      REQUIRE(sorted(all.solve()) == expected);
+
+      auto counted = dancing_links(problem);
+      configure(counted);
+      REQUIRE(counted.count() == expected.size());
+
+      auto found = dancing_links(problem);
+      configure(found);
+      auto first = found.quicksolve();
+      REQUIRE(first.empty() == expected.empty());
+      if (!expected.empty())
+        REQUIRE(check.check(first));
+    }
+  }
+}
+
+TEST_CASE("Learning nogoods agrees with the reference", "[differential]") {
+  for (std::uint64_t seed = 0; seed < 300; ++seed) {
+    CAPTURE(seed);
+    auto problem = random_instance(seed, 16);
+    auto expected = reference(problem);
+
+    // Stores this small keep evicting nogoods, or reject all of them.
+    auto store = nogood_store{64 + seed % 8 * 64, 1 + seed % 4};
+    auto matrix = dancing_links(problem);
+    matrix.set_nogood_store(&store);
+    REQUIRE(sorted(matrix.solve()) == expected);
+    REQUIRE(matrix.count() == expected.size());
+
+    // Nogoods learnt by one matrix hold for any matrix of the problem,
+    // including below a selection.
+    auto reused = dancing_links(problem);
+    reused.set_nogood_store(&store);
+    REQUIRE(reused.count() == expected.size());
+    check_prefixes(reused, expected, 2);
+    REQUIRE(reused.selection().empty());
+  }
+}
+
+#if defined(DLX_POSIX)
+// Workers are forked, so no other threads may be running in this test.
+TEST_CASE("Distributed search agrees on random problems", "[differential]") {
+  for (std::uint64_t seed = 0; seed < 40; ++seed) {
+    CAPTURE(seed);
+    auto problem = random_instance(seed);
+    auto expected = reference(problem);
+
+    auto search = coordinator{problem, {2}};
+    auto count = search.count();
+    REQUIRE(count);
+    REQUIRE(*count == expected.size());
+    auto solutions = search.solve();
+    REQUIRE(solutions);
+    REQUIRE(sorted(*solutions) == expected);
+  }
+}
+#endif
+
+TEST_CASE("Matchings and sweeps agree with the search", "[differential]") {
+  auto batch = batch_solver{2};
+  for (std::uint64_t seed = 0; seed < 600; ++seed) {
+    CAPTURE(seed);
+    auto problem = seed % 2 == 0 ? random_pairs(seed) : random_board(seed);
+    auto expected = reference(problem);
+    auto check = verifier{problem};
+
+    auto search = dancing_links(problem);
+    search.set_matching(false);
+    search.set_sweeping(false);
+    REQUIRE(search.count() == expected.size());
+    auto searched = search.quicksolve();
+    REQUIRE(searched.empty() == expected.empty());
+
+    REQUIRE(dancing_links(problem).count() == expected.size());
+    REQUIRE(batch.submit(problem, solve_mode::count).get().count ==
+            expected.size());
+    auto first = dancing_links(problem).quicksolve();
+    REQUIRE(first.empty() == expected.empty());
+    if (!expected.empty()) {
+      REQUIRE(check.check(searched));
+      REQUIRE(check.check(first));
+    }
+  }
+}
+
+TEST_CASE("Problems survive a round trip through the text format",
+          "[instance-io]") {
+  for (std::uint64_t seed = 0; seed < 50; ++seed) {
+    auto problem = random_instance(seed);
+    auto stream = std::stringstream{};
+    write_instance(stream, problem);
+    auto parsed = read_instance(stream);
+    REQUIRE(parsed);
+    REQUIRE(parsed->items == problem.items);
+    REQUIRE(parsed->options == problem.options);
+  }
+}
+
+TEST_CASE("Text format uses item names", "[instance-io]") {
+  auto parsed = parse_instance("| Comment\n"
+                               "a b c\n"
+                               "\n"
+                               "a c\n"
+                               "  b\t\r\n"
+                               "c a b");
+  REQUIRE(parsed);
+  REQUIRE(parsed->items == 3);
+  REQUIRE(parsed->options ==
+          std::vector<std::vector<std::size_t>>{{0, 2}, {1}, {2, 0, 1}});
+
+  REQUIRE(!parse_instance(""));
+  REQUIRE(!parse_instance("a b a\n"));
+  REQUIRE(!parse_instance("a b\na d\n"));
+  REQUIRE(!parse_instance("a b\na b a\n"));
+  REQUIRE(!parse_instance("a | b\na b\n"));
+  REQUIRE(!parse_instance("a b\na:red b\n"));
+}
+
+TEST_CASE("Text format parses the same on multiple threads",
+          "[instance-io]") {
+  // Enough copies of a problem to be split into several chunks, with
+  // comments and blank lines in between.
+  auto stream = std::ostringstream{};
+  write_instance(stream, langford(8));
+  auto text = stream.str();
+  auto header = text.substr(0, text.find('\n') + 1);
+  auto options = text.substr(header.size());
+  for (std::size_t copy = 0; copy < 600; ++copy)
+    text += "| Copy " + std::to_string(copy) + "\n\n" + options;
+
+  auto serial = parse_instance(text);
+  REQUIRE(serial);
+  REQUIRE(serial->options.size() == 601 * langford(8).options.size());
+  for (std::size_t threads : {2, 3, 8}) {
+    auto parallel = parse_instance(text, threads);
+    REQUIRE(parallel);
+    REQUIRE(parallel->items == serial->items);
+    REQUIRE(parallel->options == serial->options);
+  }
+
+  REQUIRE(!parse_instance(text + "0 1 0\n", 8));
+  REQUIRE(!parse_instance(header + "x\n" + text.substr(header.size()), 8));
+}
@@ -0,0 +1,98 @@
+//===-- distributed_search_test.cpp - Distributed search test ---*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests the search distributed over worker processes.
+///
+//===----------------------------------------------------------------------===//
+
+#include "catch.hpp"
+
+#include <chrono>
+#include <thread>
+
+#include <unistd.h>
+
+#include "../include/dancing_links.h"
+#include "../include/distributed_search.h"
+#include "test_instances.h"
+
+using namespace dlx;
+using namespace dlx::test;
+
+TEST_CASE("Distributed search finds the same exact covers", "[distributed]") {
+  for (std::size_t n = 3; n <= 8; ++n) {
+    auto problem = langford(n);
+    auto expected = sorted(dancing_links(problem).solve());
+    auto search = coordinator{problem, {3}};
+    auto count = search.count();
+    REQUIRE(count);
+    REQUIRE(*count == expected.size());
+    auto solutions = search.solve();
+    REQUIRE(solutions);
+    REQUIRE(sorted(*solutions) == expected);
+  }
+
+  for (std::uint64_t seed = 0; seed < 10; ++seed) {
+    auto problem = random_instance(seed);
+    auto expected = sorted(dancing_links(problem).solve());
+    auto solutions = coordinator{problem, {2}}.solve();
+    REQUIRE(solutions);
+    REQUIRE(sorted(*solutions) == expected);
+  }
+}
+
+TEST_CASE("Work of crashed workers is redone exactly once", "[distributed]") {
+  auto problem = langford(11);
+  auto expected = sorted(dancing_links(problem).solve());
+
+  // The first worker dies in the middle of its search, after it has
+  // reported some solutions and donated part of its work.
+  auto search = coordinator{problem, {3}};
+  search.set_worker_entry([](int connection, std::size_t started) {
+    if (started == 0) {
+      std::thread{[] {
+        std::this_thread::sleep_for(std::chrono::milliseconds{20});
+        ::_exit(1);
+      }}.detach();
+    }
+    run_worker(connection, connection);
+  });
+  auto solutions = search.solve();
+  REQUIRE(solutions);
+  REQUIRE(sorted(*solutions) == expected);
+
+  search.set_worker_entry([](int connection, std::size_t started) {
+    if (started == 0)
+      ::_exit(1);
+    run_worker(connection, connection);
+  });
+  auto count = search.count();
+  REQUIRE(count);
+  REQUIRE(*count == expected.size());
+}
+
+TEST_CASE("Distributed search fails once all restarts are used up",
+          "[distributed]") {
+  auto search = coordinator{langford(7), {2, {}, 3}};
+  search.set_worker_entry([](int, std::size_t) { ::_exit(1); });
+  REQUIRE(!search.count());
+}
@@ -0,0 +1,123 @@
+//===-- frontier_count_test.cpp - Frontier counting test --------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests counting the exact covers of tiling problems by sweeping over their
+/// board.
+///
+//===----------------------------------------------------------------------===//
+
+#include "catch.hpp"
+
+#include "../include/dancing_links.h"
+#include "../include/frontier_count.h"
+#include "test_instances.h"
+
+using namespace dlx;
+using namespace dlx::test;
+
+namespace {
+const auto dominoes = std::vector<std::vector<cell>>{{{0, 0}, {0, 1}},
+                                                     {{0, 0}, {1, 0}}};
+const auto l_trominoes = std::vector<std::vector<cell>>{
+    {{0, 0}, {1, 0}, {1, 1}},
+    {{0, 0}, {0, 1}, {1, 0}},
+    {{0, 0}, {0, 1}, {1, 1}},
+    {{0, 1}, {1, 0}, {1, 1}}};
+
+/// Counts exact covers by searching, without sweeping.
+auto searched(const instance &problem) -> std::size_t {
+  auto search = dancing_links{problem};
+  search.set_sweeping(false);
+  search.set_matching(false);
+  return search.count();
+}
+} // namespace
+
+TEST_CASE("Sweeps need a board", "[sweep]") {
+  REQUIRE(!plan_sweep(langford(4)));
+  REQUIRE(!plan_sweep(domino(2, 2)));
+
+  auto problem = tiling(2, 2, dominoes);
+  REQUIRE(plan_sweep(problem));
+  problem.items += 1;
+  problem.cells.push_back(std::nullopt);
+  problem.options.push_back({4});
+  REQUIRE(!plan_sweep(problem));
+}
+
+TEST_CASE("Sweeps count tilings", "[sweep]") {
+  // Tilings of 3 x 2n boards by dominoes follow a(n) = 4a(n - 1) - a(n - 2).
+  auto previous = std::size_t{1}, current = std::size_t{3};
+  for (std::size_t n = 1; n <= 20; ++n) {
+    REQUIRE(dancing_links{tiling(3, 2 * n, dominoes)}.count() == current);
+    REQUIRE(dancing_links{tiling(3, 2 * n - 1, dominoes)}.count() == 0);
+    previous = std::exchange(current, 4 * current - previous);
+  }
+  REQUIRE(dancing_links{tiling(8, 8, dominoes)}.count() == 12988816);
+
+  // Tall boards are swept row by row, across their width.
+  auto tall = dancing_links{tiling(20, 4, dominoes)};
+  tall.set_matching(false);
+  REQUIRE(tall.count() == dancing_links{tiling(4, 20, dominoes)}.count());
+  REQUIRE(dancing_links{domino(20, 4)}.count() == tall.count());
+
+  // Each 2 x 3 block of a 2 x 3n board is covered by two L-trominoes, in
+  // one of two ways.
+  for (std::size_t n = 1; n <= 10; ++n)
+    REQUIRE(dancing_links{tiling(2, 3 * n, l_trominoes)}.count() ==
+            std::size_t{1} << n);
+}
+
+TEST_CASE("Sweeps track items off the board", "[sweep]") {
+  // Two distinct 2 x 2 squares on a 2 x 4 board.
+  auto board = tiling(2, 4, {{{0, 0}, {0, 1}, {1, 0}, {1, 1}}});
+  auto problem = instance{board.items + 2, {}, board.cells};
+  problem.cells.resize(problem.items);
+  for (auto piece : {board.items, board.items + 1}) {
+    for (auto option : board.options) {
+      option.push_back(piece);
+      problem.options.push_back(option);
+    }
+  }
+  REQUIRE(dancing_links{problem}.count() == 2);
+  REQUIRE(searched(problem) == 2);
+
+  // Without room for the second square, no tiling uses both.
+  problem.options.erase(problem.options.begin() + 3, problem.options.end());
+  REQUIRE(dancing_links{problem}.count() == 0);
+}
+
+TEST_CASE("Sweeps agree with the search", "[sweep]") {
+  auto tilings = std::size_t{0};
+  for (std::uint64_t seed = 0; seed < 200; ++seed) {
+    auto problem = random_board(seed);
+    auto expected = searched(problem);
+    REQUIRE(dancing_links{problem}.count() == expected);
+    tilings += expected != 0;
+  }
+  CHECK(tilings > 30);
+
+  // Selections are extended by the search.
+  auto problem = dancing_links{tiling(2, 4, dominoes)};
+  problem.select(0);
+  REQUIRE(problem.count() == 2);
+}
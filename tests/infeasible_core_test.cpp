@@ -0,0 +1,111 @@
+//===-- infeasible_core_test.cpp - Infeasible core test ---------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests the extraction of small sets of items that already admit no exact
+/// cover.
+///
+//===----------------------------------------------------------------------===//
+
+#include "catch.hpp"
+
+#include "../include/dancing_links.h"
+#include "../include/infeasible_core.h"
+#include "test_instances.h"
+
+using namespace dlx;
+using namespace dlx::test;
+
+namespace {
+auto feasible(const instance &problem, std::span<const std::size_t> items)
+    -> bool {
+  return dancing_links{restrict_items(problem, items)}.count() != 0;
+}
+
+/// Checks that <core> is infeasible, but any smaller subset of it is not.
+void require_minimal(const instance &problem,
+                     const std::vector<std::size_t> &core) {
+  REQUIRE(!feasible(problem, core));
+  for (std::size_t i = 0; i < core.size(); ++i) {
+    auto smaller = core;
+    smaller.erase(smaller.begin() + i);
+    REQUIRE(feasible(problem, smaller));
+  }
+}
+} // namespace
+
+TEST_CASE("Restriction keeps only the chosen items", "[core]") {
+  auto problem = instance{4, {{0, 1}, {2, 3}, {1, 3}, {2}}};
+  auto items = std::vector<std::size_t>{3, 1};
+  auto restricted = restrict_items(problem, items);
+  REQUIRE(restricted.items == 2);
+  REQUIRE(restricted.options ==
+          std::vector<std::vector<std::size_t>>{{1}, {0}, {1, 0}});
+}
+
+TEST_CASE("Feasible problems have no infeasible core", "[core]") {
+  REQUIRE(!find_infeasible_core(langford(7)));
+  REQUIRE(!find_infeasible_core(instance{0, {}}));
+}
+
+TEST_CASE("Infeasible cores are minimal", "[core]") {
+  // An odd cycle of pairs cannot be covered, whatever else is added.
+  auto problem = langford(8);
+  auto first = problem.items;
+  problem.items += 3;
+  problem.options.push_back({first, first + 1});
+  problem.options.push_back({first + 1, first + 2});
+  problem.options.push_back({first, first + 2});
+
+  auto core = find_infeasible_core(problem);
+  REQUIRE(core);
+  REQUIRE(core->items ==
+          std::vector<std::size_t>{first, first + 1, first + 2});
+  REQUIRE(core->searches < problem.items);
+
+  // An item without options is a core by itself.
+  auto uncoverable = langford(7);
+  uncoverable.items += 1;
+  core = find_infeasible_core(uncoverable);
+  REQUIRE(core);
+  REQUIRE(core->items == std::vector<std::size_t>{uncoverable.items - 1});
+
+  for (auto problem : {langford(5), langford(6)}) {
+    core = find_infeasible_core(problem);
+    REQUIRE(core);
+    require_minimal(problem, core->items);
+  }
+  // Most random problems have a planted exact cover; without one of its
+  // options most become infeasible.
+  auto infeasible = std::size_t{0};
+  for (std::uint64_t seed = 0; seed < 40; ++seed) {
+    auto problem = random_instance(seed);
+    auto planted = dancing_links{problem}.quicksolve();
+    if (!planted.empty())
+      problem.options.erase(problem.options.begin() + planted.front());
+    infeasible += dancing_links{problem}.count() == 0;
+    if (auto core = find_infeasible_core(problem))
+      require_minimal(problem, core->items);
+    else
+      REQUIRE(dancing_links{problem}.count() != 0);
+  }
+  CHECK(infeasible > 10);
+}
@@ -0,0 +1,76 @@
+//===-- instance_io_fuzz.cpp - Text format fuzz target ----------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// libFuzzer entry point over the text loader, checking every problem it
+/// accepts against the solvers.
+///
+//===----------------------------------------------------------------------===//
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include <string_view>
+
+#include "../include/dancing_links.h"
+#include "../include/instance_io.h"
+#include "../include/trail_dancing_links.h"
+#include "../include/verifier.h"
+
+using namespace dlx;
+
+/// Accepted problems must survive a round trip through the writer, and both
+/// engines must agree on their solutions. Large problems are only parsed,
+/// to keep the search from dominating the fuzzing time.
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data,
+                                      std::size_t size) {
+  auto text = std::string_view{reinterpret_cast<const char *>(data), size};
+  auto problem = parse_instance(text);
+  if (!problem)
+    return 0;
+
+  for (const auto &option : problem->options) {
+    for (auto item : option) {
+      if (item >= problem->items)
+        std::abort();
+    }
+  }
+
+  auto stream = std::stringstream{};
+  write_instance(stream, *problem);
+  auto parsed = read_instance(stream);
+  if (!parsed || parsed->items != problem->items)
+    std::abort();
+
+  if (problem->items > 32 || problem->options.size() > 32)
+    return 0;
+
+  auto solutions = dancing_links(*problem).solve();
+  if (trail_dancing_links(*problem).count() != solutions.size())
+    std::abort();
+  auto check = verifier{*problem};
+  for (const auto &solution : solutions) {
+    if (!check.check(solution))
+      std::abort();
+  }
+  return 0;
+}
@@ -0,0 +1,83 @@
+//===-- item_ordering_test.cpp - Item ordering test -------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests profile-guided item ordering.
+///
+//===----------------------------------------------------------------------===//
+
+#include "catch.hpp"
+
+#include "../include/dancing_links.h"
+#include "../include/item_ordering.h"
+#include "test_instances.h"
+
+#include <sstream>
+
+using namespace dlx;
+using namespace dlx::test;
+
+TEST_CASE("Item ordering is a permutation of the items", "[ordering]") {
+  auto problem = langford(5);
+  auto order = probe_item_order(problem);
+
+  REQUIRE(order.size() == problem.items);
+  std::sort(order.begin(), order.end());
+  for (std::size_t item = 0; item < order.size(); ++item)
+    REQUIRE(order[item] == item);
+}
+
+TEST_CASE("Item ordering moves contradictions to the front", "[ordering]") {
+  auto problem = late_contradiction(10);
+  auto order = probe_item_order(problem);
+
+  auto matrix = dancing_links(problem);
+  auto unordered = matrix.tree_size(1 << 20);
+  matrix.order_items(order);
+  auto ordered = matrix.tree_size(1 << 20);
+
+  REQUIRE(ordered < 10);
+  REQUIRE(ordered < unordered);
+  REQUIRE(matrix.count() == 0);
+}
+
+TEST_CASE("Item ordering does not change solutions", "[ordering]") {
+  auto problem = langford(7);
+  auto matrix = dancing_links(problem);
+  matrix.order_items(probe_item_order(problem, {2, 64, 42}));
+
+  REQUIRE(sorted(matrix.solve()) == sorted(dancing_links(problem).solve()));
+}
+
+TEST_CASE("Item ordering can be persisted", "[ordering]") {
+  auto order = probe_item_order(langford(4));
+  auto stream = std::stringstream{};
+  write_item_order(stream, order);
+
+  REQUIRE(read_item_order(stream, order.size()) == order);
+
+  auto wrong_size = std::stringstream{"2\n0 1\n"};
+  REQUIRE(!read_item_order(wrong_size, 3));
+  auto duplicate = std::stringstream{"3\n0 1 1\n"};
+  REQUIRE(!read_item_order(duplicate, 3));
+  auto truncated = std::stringstream{"3\n0 1"};
+  REQUIRE(!read_item_order(truncated, 3));
+}
@@ -0,0 +1,106 @@
+//===-- memory_placement_test.cpp - Memory placement test -------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests huge-page backed arenas and placement of worker threads.
+///
+//===----------------------------------------------------------------------===//
+
+#include "catch.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include "../include/memory_placement.h"
+#include "../include/parallel_dancing_links.h"
+#include "test_instances.h"
+
+using namespace dlx;
+using namespace dlx::test;
+
+TEST_CASE("Huge page arenas hand out aligned, disjoint memory",
+          "[placement]") {
+  auto arena = huge_page_resource{};
+  REQUIRE(arena.stats().mapped == 0);
+
+  auto *small = static_cast<std::byte *>(arena.allocate(24, 8));
+  auto *aligned = static_cast<std::byte *>(arena.allocate(100, 64));
+  REQUIRE(reinterpret_cast<std::uintptr_t>(small) % 8 == 0);
+  REQUIRE(reinterpret_cast<std::uintptr_t>(aligned) % 64 == 0);
+  REQUIRE((aligned >= small + 24 || aligned + 100 <= small));
+  std::memset(small, 1, 24);
+  std::memset(aligned, 2, 100);
+  REQUIRE(std::to_integer<int>(small[23]) == 1);
+
+  auto stats = arena.stats();
+  REQUIRE(stats.mapped == huge_page_resource::huge_page_size);
+  REQUIRE(stats.explicit_pages + stats.advised <= stats.mapped);
+
+  // Allocations larger than the current region get a region of their own.
+  auto size = 3 * huge_page_resource::huge_page_size;
+  auto *large = static_cast<std::byte *>(arena.allocate(size, 4096));
+  std::memset(large, 3, size);
+  REQUIRE(arena.stats().mapped >= 4 * huge_page_resource::huge_page_size);
+  arena.deallocate(large, size, 4096);
+}
+
+TEST_CASE("Matrices can be built in a huge page arena", "[placement]") {
+  auto arena = huge_page_resource{};
+  auto problem = dancing_links{langford(8), &arena};
+  REQUIRE(problem.count() == 300);
+}
+
+TEST_CASE("Worker CPUs are allowed CPUs", "[placement]") {
+  auto cpus = worker_cpus(5);
+  REQUIRE(cpus.size() == 5);
+
+  // Pinning is done on a separate thread, as threads started later inherit
+  // the affinity of the thread starting them.
+  auto pinned = false, rejected = false;
+  std::thread{[&] {
+    pinned = pin_to_cpu(cpus.front());
+    rejected = !pin_to_cpu(std::size_t{1} << 20);
+  }}.join();
+  REQUIRE(pinned);
+  REQUIRE(rejected);
+}
+
+TEST_CASE("Pinned parallel search reports worker placement",
+          "[placement]") {
+  auto problem = parallel_dancing_links(langford(8), 3);
+  REQUIRE(problem.count() == 300);
+  REQUIRE(problem.placements().size() == 3);
+  for (const auto &placement : problem.placements()) {
+    REQUIRE(!placement.cpu);
+    REQUIRE(placement.memory.mapped >= huge_page_resource::huge_page_size);
+  }
+
+  problem.set_pinning(true);
+  auto expected = sorted(dancing_links(langford(8)).solve());
+  REQUIRE(sorted(problem.solve()) == expected);
+  auto cpus = worker_cpus(3);
+  for (std::size_t worker = 0; worker < 3; ++worker) {
+    REQUIRE(problem.placements()[worker].cpu == cpus[worker]);
+    REQUIRE(problem.placements()[worker].numa_node ==
+            numa_node_of(cpus[worker]));
+  }
+}
@@ -0,0 +1,111 @@
+//===-- nogood_store_test.cpp - Nogood store test ---------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests the store of learned nogoods and learning during search.
+///
+//===----------------------------------------------------------------------===//
+
+#include "catch.hpp"
+
+#include "../include/dancing_links.h"
+#include "../include/nogood_store.h"
+#include "test_instances.h"
+
+using namespace dlx;
+using namespace dlx::test;
+
+TEST_CASE("Nogood store finds nogoods completed by an option", "[nogood]") {
+  auto store = nogood_store{1 << 12};
+  store.learn(std::vector<std::size_t>{4, 1});
+
+  auto selected = std::vector<bool>(8, false);
+  REQUIRE(store.find(4, selected) == nullptr);
+  selected[1] = true;
+  REQUIRE(*store.find(4, selected) == std::vector<std::size_t>{1, 4});
+  REQUIRE(store.find(3, selected) == nullptr);
+  REQUIRE(store.hits() == 1);
+}
+
+TEST_CASE("Nogood store ignores duplicate and oversized nogoods",
+          "[nogood]") {
+  auto store = nogood_store{1 << 12, 3};
+  store.learn(std::vector<std::size_t>{1, 2});
+  store.learn(std::vector<std::size_t>{2, 1});
+  store.learn(std::vector<std::size_t>{1, 2, 3, 4});
+  store.learn(std::vector<std::size_t>{});
+  REQUIRE(store.size() == 1);
+
+  // Repeated options count once, both towards the size and the memory.
+  auto memory = store.memory();
+  store.learn(std::vector<std::size_t>{5, 6, 5, 6});
+  REQUIRE(store.size() == 2);
+  REQUIRE(store.memory() == 2 * memory);
+}
+
+TEST_CASE("Nogood store evicts least recently used nogoods", "[nogood]") {
+  auto probe = nogood_store{1 << 12};
+  probe.learn(std::vector<std::size_t>{0, 1});
+  auto store = nogood_store{2 * probe.memory()};
+
+  store.learn(std::vector<std::size_t>{0, 1});
+  store.learn(std::vector<std::size_t>{0, 2});
+  auto selected = std::vector<bool>{true, false, false, false};
+  REQUIRE(store.find(1, selected) != nullptr); // Refreshes {0, 1}.
+
+  store.learn(std::vector<std::size_t>{0, 3});
+  REQUIRE(store.size() == 2);
+  REQUIRE(store.evictions() == 1);
+  REQUIRE(store.memory() <= 2 * probe.memory());
+  REQUIRE(store.find(1, selected) != nullptr);
+  REQUIRE(store.find(2, selected) == nullptr);
+  REQUIRE(store.find(3, selected) != nullptr);
+}
+
+TEST_CASE("Learning nogoods preserves all solutions", "[nogood]") {
+  for (std::size_t n = 3; n <= 8; ++n) {
+    auto store = nogood_store{1 << 16};
+    auto problem = dancing_links(langford(n));
+    problem.set_nogood_store(&store);
+    REQUIRE(sorted(problem.solve()) ==
+            sorted(dancing_links(langford(n)).solve()));
+  }
+}
+
+TEST_CASE("Learning nogoods prunes repeated conflicts", "[nogood]") {
+  auto store = nogood_store{1 << 16};
+  auto calls = std::size_t{0};
+  auto problem = dancing_links(late_contradiction(16));
+  problem.set_nogood_store(&store);
+  problem.enumerate([&calls](auto) { ++calls; });
+
+  REQUIRE(calls == 0);
+  REQUIRE(problem.selection().empty());
+}
+
+TEST_CASE("Learning respects a store with a small budget", "[nogood]") {
+  auto store = nogood_store{256, 4};
+  auto problem = dancing_links(langford(8));
+  problem.set_nogood_store(&store);
+
+  REQUIRE(problem.count() == 300);
+  REQUIRE(store.memory() <= 256);
+}
@@ -0,0 +1,70 @@
+//===-- parallel_dancing_links_test.cpp - Parallel search test --*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests the multi-threaded search for exact covers.
+///
+//===----------------------------------------------------------------------===//
+
+#include "catch.hpp"
+
+#include "../include/parallel_dancing_links.h"
+#include "test_instances.h"
+
+using namespace dlx;
+using namespace dlx::test;
+
+TEST_CASE("Sequential search counts Langford pairs", "[dancing-links]") {
+  REQUIRE(dancing_links(langford(3)).count() == 2);
+  REQUIRE(dancing_links(langford(4)).count() == 2);
+  REQUIRE(dancing_links(langford(5)).count() == 0);
+  REQUIRE(dancing_links(langford(7)).count() == 52);
+}
+
+TEST_CASE("Selections restrict and are undone by deselection",
+          "[dancing-links]") {
+  auto problem = dancing_links(4, {{1, 2}, {0}, {0, 3}, {3}});
+  problem.select(2);
+  REQUIRE(problem.solve() == std::vector<std::vector<std::size_t>>{{2, 0}});
+  problem.deselect();
+  REQUIRE(problem.selection().empty());
+  REQUIRE(problem.count() == 2);
+}
+
+TEST_CASE("Parallel search finds the same solutions as sequential search",
+          "[parallel]") {
+  auto sequential = dancing_links(langford(7)).solve();
+  for (std::size_t threads : {1, 2, 5}) {
+    auto parallel = parallel_dancing_links(langford(7), threads);
+    REQUIRE(sorted(parallel.solve()) == sorted(sequential));
+  }
+}
+
+TEST_CASE("Parallel search counts dense solution sets", "[parallel]") {
+  auto problem = parallel_dancing_links(langford(8), 4);
+  REQUIRE(problem.count() == 300);
+}
+
+TEST_CASE("Parallel search handles absence of solutions", "[parallel]") {
+  auto problem = parallel_dancing_links(langford(5), 3);
+  REQUIRE(problem.solve().empty());
+  REQUIRE(problem.count() == 0);
+}
@@ -0,0 +1,120 @@
+//===-- perfect_matching_test.cpp - Perfect matching test -------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests solving problems with options of two items as perfect matchings.
+///
+//===----------------------------------------------------------------------===//
+
+#include "catch.hpp"
+
+#include "../include/dancing_links.h"
+#include "../include/perfect_matching.h"
+#include "test_instances.h"
+
+using namespace dlx;
+using namespace dlx::test;
+
+namespace {
+/// Checks that the options <chosen> cover every item exactly once.
+void require_cover(const instance &problem,
+                   const std::vector<std::size_t> &chosen) {
+  auto covered = std::vector<std::size_t>(problem.items);
+  for (auto index : chosen)
+    for (auto item : problem.options[index])
+      ++covered[item];
+  REQUIRE(std::all_of(covered.begin(), covered.end(),
+                      [](auto times) { return times == 1; }));
+}
+} // namespace
+
+TEST_CASE("Domino tilings are counted as perfect matchings", "[matching]") {
+  // Tilings of 2 x n grids follow the Fibonacci numbers.
+  auto previous = std::size_t{1}, current = std::size_t{1};
+  for (std::size_t n = 1; n <= 30; ++n) {
+    REQUIRE(dancing_links{domino(2, n)}.count() == current);
+    previous = std::exchange(current, current + previous);
+  }
+  REQUIRE(dancing_links{domino(3, 3)}.count() == 0);
+  REQUIRE(dancing_links{domino(4, 4)}.count() == 36);
+  REQUIRE(dancing_links{domino(6, 6)}.count() == 6728);
+  REQUIRE(dancing_links{domino(8, 8)}.count() == 12988816);
+
+  auto search = dancing_links{domino(4, 5)};
+  search.set_matching(false);
+  REQUIRE(search.count() == 95);
+}
+
+TEST_CASE("Perfect matchings are exact covers", "[matching]") {
+  for (auto [rows, cols] : {std::pair{4, 4}, {5, 6}, {9, 12}}) {
+    auto problem = domino(rows, cols);
+    require_cover(problem, dancing_links{problem}.quicksolve());
+  }
+
+  // Without two opposite corners, the board has more cells of one colour.
+  auto mutilated = domino(8, 8);
+  mutilated.items -= 1;
+  std::erase_if(mutilated.options, [&](const auto &option) {
+    return option[0] == 0 || option[1] == mutilated.items;
+  });
+  for (auto &option : mutilated.options)
+    for (auto &item : option)
+      --item;
+  mutilated.items -= 1;
+  REQUIRE(dancing_links{mutilated}.quicksolve().empty());
+  REQUIRE(dancing_links{mutilated}.count() == 0);
+
+  // The odd cycle at the end can only be ruled out by looking past it.
+  REQUIRE(dancing_links{late_contradiction(40)}.quicksolve().empty());
+  REQUIRE(dancing_links{late_contradiction(40)}.count() == 0);
+}
+
+TEST_CASE("Matchings agree with the search", "[matching]") {
+  auto solvable = std::size_t{0};
+  for (std::uint64_t seed = 0; seed < 300; ++seed) {
+    auto problem = random_pairs(seed);
+    auto search = dancing_links{problem};
+    search.set_matching(false);
+    auto expected = search.count();
+    REQUIRE(dancing_links{problem}.count() == expected);
+
+    auto edges = std::vector<edge>{};
+    for (const auto &option : problem.options)
+      edges.push_back({option[0], option[1]});
+    auto matching = find_perfect_matching(problem.items, edges);
+    REQUIRE(matching.has_value() == (expected != 0));
+    if (matching) {
+      require_cover(problem, *matching);
+      ++solvable;
+    }
+  }
+  CHECK(solvable > 30);
+}
+
+TEST_CASE("Selections are extended by the search", "[matching]") {
+  auto problem = domino(2, 4);
+  auto search = dancing_links{problem};
+  search.select(1);
+  auto solution = search.quicksolve();
+  REQUIRE(std::find(solution.begin(), solution.end(), 1) != solution.end());
+  require_cover(problem, solution);
+  REQUIRE(search.count() == 3);
+}
@@ -0,0 +1,187 @@
+//===-- result_cache_test.cpp - Result cache test ---------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests canonical forms and the cache of solve results built on them.
+///
+//===----------------------------------------------------------------------===//
+
+#include "catch.hpp"
+
+#include <iterator>
+#include <numeric>
+#include <random>
+
+#include "../include/batch_solver.h"
+#include "../include/canonical_form.h"
+#include "../include/dancing_links.h"
+#include "../include/result_cache.h"
+#include "test_instances.h"
+
+using namespace dlx;
+using namespace dlx::test;
+
+namespace {
+/// Renumbers the items and shuffles the options of a problem.
+auto permuted(const instance &problem, std::uint64_t seed) -> instance {
+  auto random = std::mt19937_64{seed};
+  auto items = std::vector<std::size_t>(problem.items);
+  std::iota(items.begin(), items.end(), 0);
+  std::shuffle(items.begin(), items.end(), random);
+  auto order = std::vector<std::size_t>(problem.options.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), random);
+
+  auto result = instance{problem.items};
+  for (auto option : order) {
+    auto &items_of = result.options.emplace_back();
+    for (auto item : problem.options[option])
+      items_of.push_back(items[item]);
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("Renumbered problems share their canonical form", "[cache]") {
+  auto problem = langford(6);
+  auto form = canonicalize(problem);
+  for (std::uint64_t seed = 0; seed < 10; ++seed) {
+    auto other = canonicalize(permuted(problem, seed));
+    REQUIRE(other.hash == form.hash);
+    REQUIRE(other.problem.options == form.problem.options);
+  }
+  REQUIRE(canonicalize(langford(7)).hash != form.hash);
+}
+
+TEST_CASE("Canonical solutions translate back to the original options",
+          "[cache]") {
+  for (std::uint64_t seed = 0; seed < 30; ++seed) {
+    auto problem = random_instance(seed);
+    auto form = canonicalize(problem);
+    auto translated = std::vector<std::vector<std::size_t>>{};
+    for (const auto &solution : dancing_links(form.problem).solve())
+      translated.push_back(form.original(solution));
+    REQUIRE(sorted(translated) == sorted(dancing_links(problem).solve()));
+  }
+}
+
+TEST_CASE("Canonical forms keep the positions of cells", "[cache]") {
+  auto problem = tiling(3, 4, {{{0, 0}, {0, 1}},
+                               {{0, 0}, {1, 0}},
+                               {{0, 0}, {1, 0}, {1, 1}}});
+  auto form = canonicalize(problem);
+  auto positions = [](const instance &problem, std::size_t option) {
+    auto result = std::vector<cell>{};
+    for (auto item : problem.options[option])
+      result.push_back(*problem.cells[item]);
+    std::sort(result.begin(), result.end(), [](auto left, auto right) {
+      return std::pair{left.row, left.column} <
+             std::pair{right.row, right.column};
+    });
+    return result;
+  };
+  for (std::size_t i = 0; i < form.problem.options.size(); ++i)
+    REQUIRE(positions(form.problem, i) == positions(problem, form.options[i]));
+  REQUIRE(plan_sweep(form.problem));
+}
+
+TEST_CASE("Result cache evicts the least recently used result", "[cache]") {
+  auto cache = result_cache{2};
+  auto forms = std::vector<canonical_instance>{};
+  for (std::size_t n : {4, 5, 6})
+    forms.push_back(canonicalize(langford(n)));
+
+  for (const auto &form : forms) {
+    REQUIRE(!cache.lookup(form, solve_mode::count));
+    cache.store(form, solve_mode::count, {form.problem.items});
+  }
+  REQUIRE(!cache.lookup(forms[0], solve_mode::count));
+  REQUIRE(cache.lookup(forms[1], solve_mode::count).value().count == 15);
+  REQUIRE(cache.lookup(forms[2], solve_mode::count).value().count == 18);
+  REQUIRE(!cache.lookup(forms[2], solve_mode::all));
+  REQUIRE(cache.hits() == 2);
+  REQUIRE(cache.misses() == 5);
+}
+
+TEST_CASE("Results for all solutions answer every mode", "[cache]") {
+  auto problem = langford(7);
+  auto shuffled = permuted(problem, 3);
+  auto form = canonicalize(problem);
+  auto cache = result_cache{4};
+  auto solutions = dancing_links(form.problem).solve();
+  cache.store(form, solve_mode::all, {solutions.size(), solutions});
+
+  auto other = canonicalize(shuffled);
+  auto count = cache.lookup(other, solve_mode::count);
+  REQUIRE(count);
+  REQUIRE(count->count == 52);
+  REQUIRE(count->solutions.empty());
+  auto first = cache.lookup(other, solve_mode::first);
+  REQUIRE(first);
+  REQUIRE(first->count == 1);
+  auto all = cache.lookup(other, solve_mode::all);
+  REQUIRE(all);
+  REQUIRE(sorted(all->solutions) == sorted(dancing_links(shuffled).solve()));
+}
+
+TEST_CASE("Result cache persists results to disk", "[cache]") {
+  auto directory = std::filesystem::temp_directory_path() /
+                   ("dlx-cache-" + std::to_string(std::random_device{}()));
+  auto form = canonicalize(langford(5));
+  {
+    auto cache = result_cache{1, directory};
+    cache.store(form, solve_mode::first, {1, {{0, 1, 2, 3, 4}}});
+    cache.store(form, solve_mode::first, {1, {{0, 1, 2, 3, 4}}});
+  }
+  // Entries are renamed into place, so no temporary files are left behind.
+  auto files = std::distance(std::filesystem::directory_iterator{directory},
+                             std::filesystem::directory_iterator{});
+  REQUIRE(files == 1);
+  {
+    auto cache = result_cache{1, directory};
+    auto result = cache.lookup(form, solve_mode::first);
+    REQUIRE(result);
+    REQUIRE(result->solutions ==
+            std::vector<std::vector<std::size_t>>{form.original(
+                std::vector<std::size_t>{0, 1, 2, 3, 4})});
+    REQUIRE(!cache.lookup(canonicalize(langford(4)), solve_mode::first));
+  }
+  std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("Batch solver answers repeated problems from the cache",
+          "[cache]") {
+  auto cache = result_cache{16};
+  auto solver = batch_solver{2};
+  solver.set_cache(&cache);
+
+  auto problem = langford(7);
+  auto expected = sorted(dancing_links(problem).solve());
+  REQUIRE(sorted(solver.submit(problem).get().solutions) == expected);
+  for (std::uint64_t seed = 0; seed < 4; ++seed) {
+    auto shuffled = permuted(problem, seed);
+    auto result = solver.submit(shuffled).get();
+    REQUIRE(sorted(result.solutions) ==
+            sorted(dancing_links(shuffled).solve()));
+  }
+  REQUIRE(cache.hits() == 4);
+  REQUIRE(cache.misses() == 1);
+}
@@ -0,0 +1,197 @@
+//===-- solve_server_test.cpp - Solve server test ---------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests the binary instance format and the Unix socket solve server.
+///
+//===----------------------------------------------------------------------===//
+
+#include "catch.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../include/dancing_links.h"
+#include "../include/instance_io.h"
+#include "../include/solve_server.h"
+#include "test_instances.h"
+
+using namespace dlx;
+using namespace dlx::test;
+
+namespace {
+/// Socket path private to a test run.
+auto socket_path() -> std::filesystem::path {
+  return std::filesystem::temp_directory_path() /
+         ("dlx-" + std::to_string(std::random_device{}()) + ".sock");
+}
+} // namespace
+
+TEST_CASE("Problems survive the binary format", "[server]") {
+  for (std::uint64_t seed = 0; seed < 20; ++seed) {
+    auto problem = random_instance(seed);
+    auto decoded = decode_instance(encode_instance(problem));
+    REQUIRE(decoded);
+    REQUIRE(decoded->items == problem.items);
+    REQUIRE(decoded->options == problem.options);
+  }
+
+  auto data = encode_instance(instance{3, {{0, 1}, {2}}});
+  REQUIRE(!decode_instance(std::span{data}.first(data.size() - 1)));
+  data.push_back(0);
+  REQUIRE(!decode_instance(data));
+  REQUIRE(!decode_instance(encode_instance(instance{2, {{0, 2}}})));
+  REQUIRE(!decode_instance(encode_instance(instance{2, {{1, 1}}})));
+
+  // Positions of cells, with an item off the board.
+  auto board = tiling(2, 3, {{{0, 0}, {0, 1}}});
+  board.items += 1;
+  board.cells.push_back(std::nullopt);
+  auto decoded = decode_instance(encode_instance(board));
+  REQUIRE(decoded);
+  REQUIRE(decoded->options == board.options);
+  REQUIRE(decoded->cells == board.cells);
+  data = encode_instance(board);
+  REQUIRE(!decode_instance(std::span{data}.first(data.size() - 4)));
+}
+
+TEST_CASE("Solve server answers requests in every mode", "[server]") {
+  auto path = socket_path();
+  auto server = solve_server{2};
+  REQUIRE(server.listen(path));
+
+  auto problem = langford(7);
+  auto expected = sorted(dancing_links(problem).solve());
+  auto all = request_solve(path, problem, solve_mode::all);
+  REQUIRE(all);
+  REQUIRE(all->status == reply_status::ok);
+  REQUIRE(all->count == 52);
+  REQUIRE(sorted(all->solutions) == expected);
+
+  auto count = request_solve(path, problem, solve_mode::count);
+  REQUIRE(count);
+  REQUIRE(count->count == 52);
+  REQUIRE(count->solutions.empty());
+
+  auto first = request_solve(path, problem, solve_mode::first);
+  REQUIRE(first);
+  REQUIRE(first->solutions.size() == 1);
+  REQUIRE(std::binary_search(expected.begin(), expected.end(),
+                             sorted({first->solutions[0]})[0]));
+
+  server.stop();
+  REQUIRE(!std::filesystem::exists(path));
+  REQUIRE(!request_solve(path, problem, solve_mode::count));
+}
+
+TEST_CASE("Solve server enforces its limits", "[server]") {
+  auto path = socket_path();
+  auto limits = server_limits{};
+  limits.max_items = 30;
+  limits.max_solutions = 5;
+  auto server = solve_server{1, limits};
+  REQUIRE(server.listen(path));
+
+  auto truncated = request_solve(path, langford(7), solve_mode::all);
+  REQUIRE(truncated);
+  REQUIRE(truncated->status == reply_status::truncated);
+  REQUIRE(truncated->count == 52);
+  REQUIRE(truncated->solutions.size() == 5);
+
+  auto too_large = request_solve(path, langford(11), solve_mode::count);
+  REQUIRE(too_large);
+  REQUIRE(too_large->status == reply_status::too_large);
+}
+
+TEST_CASE("Solve server bounds and cancels searches", "[server]") {
+  auto path = socket_path();
+  auto limits = server_limits{};
+  limits.max_nodes = 1000;
+  auto server = solve_server{1, limits};
+  REQUIRE(server.listen(path));
+  auto exhausted = request_solve(path, langford(11), solve_mode::count);
+  REQUIRE(exhausted);
+  REQUIRE(exhausted->status == reply_status::exhausted);
+  REQUIRE(exhausted->count < 35584);
+  REQUIRE(request_solve(path, langford(7), solve_mode::count)->status ==
+          reply_status::ok);
+
+  // Stopping does not wait for a long search to finish.
+  auto unbounded = solve_server{1};
+  auto other = socket_path();
+  REQUIRE(unbounded.listen(other));
+  auto client = std::thread{
+      [&] { request_solve(other, langford(16), solve_mode::count); }};
+  std::this_thread::sleep_for(std::chrono::milliseconds{50});
+  auto start = std::chrono::steady_clock::now();
+  unbounded.stop();
+  client.join();
+  REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds{5});
+}
+
+TEST_CASE("Solve server only replaces stale sockets", "[server]") {
+  auto path = socket_path();
+  std::ofstream{path} << "not a socket";
+  REQUIRE(!solve_server{1}.listen(path));
+  REQUIRE(std::filesystem::is_regular_file(path));
+  std::filesystem::remove(path);
+
+  // A socket left behind by a server that did not clean up.
+  auto stale = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  auto address = sockaddr_un{};
+  address.sun_family = AF_UNIX;
+  std::strcpy(address.sun_path, path.c_str());
+  REQUIRE(::bind(stale, reinterpret_cast<sockaddr *>(&address),
+                 sizeof(address)) == 0);
+  ::close(stale);
+  auto server = solve_server{1};
+  REQUIRE(server.listen(path));
+  REQUIRE(request_solve(path, langford(4), solve_mode::count)->count == 2);
+}
+
+TEST_CASE("Solve server queues excess connections", "[server]") {
+  auto path = socket_path();
+  auto limits = server_limits{};
+  limits.max_connections = 2;
+  auto server = solve_server{2, limits};
+  REQUIRE(server.listen(path));
+
+  auto counts = std::vector<std::size_t>(8);
+  auto clients = std::vector<std::thread>{};
+  for (std::size_t client = 0; client < counts.size(); ++client) {
+    clients.emplace_back([&, client] {
+      auto reply = request_solve(path, langford(3 + client % 5),
+                                 solve_mode::count);
+      counts[client] = reply ? reply->count : 1234;
+    });
+  }
+  for (auto &client : clients)
+    client.join();
+
+  auto expected = std::vector<std::size_t>{2, 2, 0, 0, 52, 2, 2, 0};
+  REQUIRE(counts == expected);
+}
@@ -0,0 +1,196 @@
+//===-- test_instances.h - Test instances -----------------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Generators for exact cover problems with known solution counts, shared
+/// between tests.
+///
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "../include/instance.h"
+
+namespace dlx::test {
+/// Langford pairs of order n as an exact cover problem: items 0..n-1 denote
+/// the numbers to place, items n..3n-1 the slots. Number k + 1 occupies two
+/// slots k + 2 apart.
+inline auto langford(std::size_t n) -> instance {
+  auto problem = instance{3 * n};
+  for (std::size_t k = 0; k < n; ++k) {
+    for (std::size_t slot = 0; slot + k + 2 < 2 * n; ++slot) {
+      problem.options.push_back({k, n + slot, n + slot + k + 2});
+    }
+  }
+  return problem;
+}
+
+/// Pairs of items that can be covered in two ways each, followed by three
+/// items that cannot be covered together. Every item has two options, so
+/// default tie-breaking explores all 2^pairs covers of the pairs before
+/// running into the contradiction.
+inline auto late_contradiction(std::size_t pairs) -> instance {
+  auto problem = instance{2 * pairs + 3};
+  for (std::size_t pair = 0; pair < pairs; ++pair) {
+    problem.options.push_back({2 * pair, 2 * pair + 1});
+    problem.options.push_back({2 * pair, 2 * pair + 1});
+  }
+  auto last = 2 * pairs;
+  problem.options.push_back({last, last + 1});
+  problem.options.push_back({last, last + 2});
+  problem.options.push_back({last + 1, last + 2});
+  return problem;
+}
+
+/// Domino tilings of a grid with <rows> rows and <cols> columns, with items
+/// numbered row by row. Every option covers two neighbouring cells.
+inline auto domino(std::size_t rows, std::size_t cols) -> instance {
+  auto problem = instance{rows * cols};
+  for (std::size_t row = 0; row < rows; ++row) {
+    for (std::size_t col = 0; col < cols; ++col) {
+      auto cell = row * cols + col;
+      if (col + 1 < cols)
+        problem.options.push_back({cell, cell + 1});
+      if (row + 1 < rows)
+        problem.options.push_back({cell, cell + cols});
+    }
+  }
+  return problem;
+}
+
+/// Tilings of a board with <rows> rows and <cols> columns by translations of
+/// <shapes>, each given by the offsets of its cells. Items are the cells of
+/// the board, numbered row by row, and carry their positions.
+inline auto tiling(std::size_t rows, std::size_t cols,
+                   const std::vector<std::vector<cell>> &shapes) -> instance {
+  auto problem = instance{rows * cols};
+  for (std::size_t row = 0; row < rows; ++row)
+    for (std::size_t col = 0; col < cols; ++col)
+      problem.cells.push_back(cell{row, col});
+  for (const auto &shape : shapes) {
+    for (std::size_t row = 0; row < rows; ++row) {
+      for (std::size_t col = 0; col < cols; ++col) {
+        auto fits = [&](auto offset) {
+          return row + offset.row < rows && col + offset.column < cols;
+        };
+        if (!std::all_of(shape.begin(), shape.end(), fits))
+          continue;
+        auto &option = problem.options.emplace_back();
+        for (auto offset : shape)
+          option.push_back((row + offset.row) * cols + col + offset.column);
+      }
+    }
+  }
+  return problem;
+}
+
+/// Random problem with up to <max_items> items. A random partition of the
+/// items is planted among the options, so that most problems are solvable,
+/// and is mixed with random options of up to four items. Options are
+/// shuffled so that the planted solution is not found first.
+inline auto random_instance(std::uint64_t seed, std::size_t max_items = 12)
+    -> instance {
+  auto random = std::mt19937_64{seed};
+  auto uniform = [&](std::size_t low, std::size_t high) {
+    return std::uniform_int_distribution<std::size_t>{low, high}(random);
+  };
+
+  auto problem = instance{uniform(1, max_items)};
+  auto items = std::vector<std::size_t>(problem.items);
+  std::iota(items.begin(), items.end(), 0);
+  if (uniform(0, 3)) {
+    std::shuffle(items.begin(), items.end(), random);
+    for (std::size_t begin = 0; begin < items.size();) {
+      auto end = std::min(items.size(), begin + uniform(1, 3));
+      problem.options.emplace_back(items.begin() + begin, items.begin() + end);
+      begin = end;
+    }
+  }
+  for (auto extra = uniform(0, 3 * problem.items); extra > 0; --extra) {
+    std::shuffle(items.begin(), items.end(), random);
+    auto size = uniform(1, std::min<std::size_t>(4, items.size()));
+    problem.options.emplace_back(items.begin(), items.begin() + size);
+  }
+  std::shuffle(problem.options.begin(), problem.options.end(), random);
+  return problem;
+}
+
+/// Random problem with up to <max_items> items in which every option covers
+/// two items, as edges of a graph. A random pairing of the items is planted
+/// among the options in most problems with an even number of items, and
+/// parallel edges may occur.
+inline auto random_pairs(std::uint64_t seed, std::size_t max_items = 14)
+    -> instance {
+  auto random = std::mt19937_64{seed};
+  auto uniform = [&](std::size_t low, std::size_t high) {
+    return std::uniform_int_distribution<std::size_t>{low, high}(random);
+  };
+
+  auto problem = instance{uniform(2, max_items)};
+  auto items = std::vector<std::size_t>(problem.items);
+  std::iota(items.begin(), items.end(), 0);
+  if (problem.items % 2 == 0 && uniform(0, 3)) {
+    std::shuffle(items.begin(), items.end(), random);
+    for (std::size_t i = 0; i < items.size(); i += 2)
+      problem.options.push_back({items[i], items[i + 1]});
+  }
+  for (auto extra = uniform(0, 2 * problem.items); extra > 0; --extra) {
+    std::shuffle(items.begin(), items.end(), random);
+    problem.options.push_back({items[0], items[1]});
+  }
+  std::shuffle(problem.options.begin(), problem.options.end(), random);
+  return problem;
+}
+
+/// Random tiling problem on a board of up to 4 x 5 cells, by a random choice
+/// of dominoes and trominoes in their orientations. Some placements are left
+/// out, so that not every board can be tiled.
+inline auto random_board(std::uint64_t seed) -> instance {
+  const auto pool = std::vector<std::vector<cell>>{
+      {{0, 0}, {0, 1}},         {{0, 0}, {1, 0}},
+      {{0, 0}, {1, 0}, {1, 1}}, {{0, 0}, {0, 1}, {1, 0}},
+      {{0, 0}, {0, 1}, {1, 1}}, {{0, 1}, {1, 0}, {1, 1}},
+      {{0, 0}, {0, 1}, {0, 2}}, {{0, 0}, {1, 0}, {2, 0}}};
+  auto random = std::mt19937_64{seed};
+  auto shapes = std::vector<std::vector<cell>>{};
+  for (const auto &shape : pool)
+    if (random() % 2 == 0)
+      shapes.push_back(shape);
+  auto problem = tiling(1 + random() % 4, 1 + random() % 5, shapes);
+  std::erase_if(problem.options, [&](auto &) { return random() % 8 == 0; });
+  return problem;
+}
+
+/// Brings solutions into a canonical order, so that solution sets found by
+/// different search orders can be compared.
+inline auto sorted(std::vector<std::vector<std::size_t>> solutions) {
+  for (auto &solution : solutions)
+    std::sort(solution.begin(), solution.end());
+  std::sort(solutions.begin(), solutions.end());
+  return solutions;
+}
+} // namespace dlx::test
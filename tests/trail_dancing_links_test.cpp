@@ -0,0 +1,100 @@
+//===-- trail_dancing_links_test.cpp - Undo-trail search test ---*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests the exact cover search with an undo trail.
+///
+//===----------------------------------------------------------------------===//
+
+#include "catch.hpp"
+
+#include "../include/trail_dancing_links.h"
+#include "test_instances.h"
+
+using namespace dlx;
+using namespace dlx::test;
+
+TEST_CASE("Trail solver correctly identifies solutions", "[trail]") {
+  auto problem = trail_dancing_links(4, {{1, 2}, {0}, {0, 3}, {3}});
+  auto solutions = problem.solve();
+
+  REQUIRE(sorted(solutions) ==
+          std::vector<std::vector<std::size_t>>{{0, 1, 3}, {0, 2}});
+  REQUIRE(problem.trail_size() == 0);
+}
+
+TEST_CASE("Trail solver agrees with dancing links", "[trail]") {
+  for (std::size_t n = 3; n <= 8; ++n) {
+    auto expected = dancing_links(langford(n)).count();
+    REQUIRE(trail_dancing_links(langford(n)).count() == expected);
+  }
+  REQUIRE(sorted(trail_dancing_links(langford(7)).solve()) ==
+          sorted(dancing_links(langford(7)).solve()));
+  REQUIRE(trail_dancing_links(langford(5)).quicksolve().empty());
+  REQUIRE(trail_dancing_links(langford(7)).quicksolve().size() == 7);
+}
+
+TEST_CASE("Trail solver rolls back to any depth", "[trail]") {
+  auto problem = trail_dancing_links(langford(8));
+  auto total = problem.count();
+
+  problem.select(problem.candidates()[0]);
+  auto trail = problem.trail_size();
+  auto below = problem.count();
+  problem.select(problem.candidates()[0]);
+  problem.select(problem.candidates()[0]);
+
+  problem.rollback(1);
+  REQUIRE(problem.selection().size() == 1);
+  REQUIRE(problem.trail_size() == trail);
+  REQUIRE(problem.count() == below);
+
+  problem.rollback(0);
+  REQUIRE(problem.trail_size() == 0);
+  REQUIRE(problem.count() == total);
+}
+
+TEST_CASE("Trail solver state can be handed to another solver", "[trail]") {
+  auto victim = trail_dancing_links(langford(8));
+  auto branches = victim.candidates();
+  victim.select(branches[0]);
+  victim.select(victim.candidates()[0]);
+  victim.select(victim.candidates()[0]);
+
+  // Hand over the state at depth one and steal a sibling branch there.
+  auto state = victim.export_state(1);
+  REQUIRE(state.selection == std::vector<std::size_t>{branches[0]});
+
+  auto expected = trail_dancing_links(langford(8));
+  expected.select(branches[0]);
+  auto siblings = expected.candidates();
+  expected.select(siblings.back());
+
+  auto thief = trail_dancing_links(langford(8));
+  thief.import_state(state);
+  REQUIRE(thief.candidates() == siblings);
+  thief.select(siblings.back());
+  REQUIRE(thief.count() == expected.count());
+
+  thief.rollback(0);
+  REQUIRE(thief.trail_size() == 0);
+  REQUIRE(thief.count() == trail_dancing_links(langford(8)).count());
+}
@@ -0,0 +1,86 @@
+//===-- verifier_test.cpp - Solution verifier test --------------*- C++ -*-===//
+//
+// Constraint-propagating sudoku solver.
+// Copyright(C) 2019 Quinten van Woerkom
+//
+// This program is free software; you can redistribute it and / or
+// modify it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or (at your
+// option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc., 51
+// Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// Tests the independent validation of exact covers.
+///
+//===----------------------------------------------------------------------===//
+
+#include "catch.hpp"
+
+#include "../include/dancing_links.h"
+#include "../include/verifier.h"
+#include "test_instances.h"
+
+using namespace dlx;
+using namespace dlx::test;
+
+TEST_CASE("Verifier accepts exact covers", "[verifier]") {
+  auto problem = langford(8);
+  auto check = verifier{problem};
+  for (const auto &solution : dancing_links(problem).solve())
+    REQUIRE(check.check(solution));
+}
+
+TEST_CASE("Verifier rejects invalid covers", "[verifier]") {
+  auto problem = instance{130, {}};
+  for (std::size_t item = 0; item < 130; item += 2)
+    problem.options.push_back({item, item + 1});
+  problem.options.push_back({0, 129});
+
+  auto check = verifier{problem};
+  auto valid = std::vector<std::size_t>{};
+  for (std::size_t option = 0; option < 65; ++option)
+    valid.push_back(option);
+  REQUIRE(check.check(valid));
+
+  auto missing = valid;
+  missing.pop_back();
+  REQUIRE(!check.check(missing));
+
+  auto overlapping = valid;
+  overlapping.push_back(65);
+  REQUIRE(!check.check(overlapping));
+
+  auto repeated = valid;
+  repeated.back() = 0;
+  REQUIRE(!check.check(repeated));
+
+  auto out_of_range = valid;
+  out_of_range.push_back(66);
+  REQUIRE(!check.check(out_of_range));
+  REQUIRE(check.check(valid)); // Scratch space is left clean.
+}
+
+TEST_CASE("Verifier checks solution streams in parallel", "[verifier]") {
+  auto problem = langford(7);
+  auto solutions = dancing_links(problem).solve();
+  solutions[3].pop_back();
+  solutions[17].push_back(solutions[17].front());
+  solutions.back() = {};
+
+  auto check = verifier{problem};
+  auto expected =
+      std::vector<std::size_t>{3, 17, solutions.size() - 1};
+  for (std::size_t threads : {1, 3, 8, 100})
+    REQUIRE(check.check_all(solutions, threads) == expected);
+  REQUIRE(check.check_all({}).empty());
+}